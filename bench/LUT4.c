@@ -38,10 +38,7 @@ uint8_t *ptr;
 void init(void) { ptr = (uint8_t*)mem; }
 
 ux checksum(size_t n) {
-	ux sum = 0;
-	for (size_t i = 0; i < n; ++i)
-		sum = uhash(sum) + ptr[i];
-	return sum;
+	return bench_hash(0, ptr, n);
 }
 
 BENCH_BEG(base) {
@@ -0,0 +1,363 @@
+#include "bench.h"
+
+/* AES-GCM with a 96-bit IV and a 128-bit tag, see NIST SP 800-38D */
+
+typedef struct {
+	/* round keys, in the byte order of FIPS-197 */
+	uint8_t rk[15][16];
+	uint64_t rounds, maxk;
+	/* hpow[i] = H^(maxk-i), in the GCM byte order */
+	uint8_t hpow[16][16];
+	/* big endian round key words, and the 4-bit GHASH tables with
+	 * hh[i]:hl[i] = i*H, for the scalar impl */
+	uint32_t ek[60];
+	uint64_t hh[16], hl[16];
+} Gcm;
+
+static uint8_t sbox[256];
+static uint32_t te[4][256];
+
+static uint32_t
+load_be32(uint8_t const *p)
+{
+	return (uint32_t)p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3];
+}
+
+static void
+store_be32(uint8_t *p, uint32_t x)
+{
+	p[0] = x >> 24; p[1] = x >> 16; p[2] = x >> 8; p[3] = x;
+}
+
+static uint64_t
+load_be64(uint8_t const *p)
+{
+	return (uint64_t)load_be32(p) << 32 | load_be32(p + 4);
+}
+
+static void
+store_be64(uint8_t *p, uint64_t x)
+{
+	store_be32(p, x >> 32); store_be32(p + 4, x);
+}
+
+#define ROR32(x,n) ((x) >> (n) | (x) << (32 - (n)))
+
+static uint8_t
+xtime(uint8_t x)
+{
+	return x << 1 ^ (x & 0x80 ? 0x1b : 0);
+}
+
+/* p walks the multiplicative group with the generator 3, and q with its
+ * inverse, so q = p^-1, then the affine transformation is applied */
+static void
+aes_tables(void)
+{
+	uint8_t p = 1, q = 1;
+	do {
+		p ^= xtime(p);
+		q ^= q << 1;
+		q ^= q << 2;
+		q ^= q << 4;
+		q ^= q & 0x80 ? 0x09 : 0;
+		uint8_t x = q ^ (q << 1 | q >> 7) ^ (q << 2 | q >> 6) ^
+		            (q << 3 | q >> 5) ^ (q << 4 | q >> 4);
+		sbox[p] = x ^ 0x63;
+	} while (p != 1);
+	sbox[0] = 0x63;
+
+	for (size_t i = 0; i < 256; ++i) {
+		uint8_t s = sbox[i], s2 = xtime(s);
+		uint32_t x = (uint32_t)s2 << 24 | s << 16 | s << 8 | (s2 ^ s);
+		for (size_t k = 0; k < 4; ++k, x = ROR32(x, 8))
+			te[k][i] = x;
+	}
+}
+
+static uint32_t
+aes_subword(uint32_t x)
+{
+	return (uint32_t)sbox[x >> 24] << 24 | sbox[x >> 16 & 0xff] << 16 |
+	       sbox[x >> 8 & 0xff] << 8 | sbox[x & 0xff];
+}
+
+static void
+aes_encrypt(Gcm const *g, uint8_t dst[16], uint8_t const src[16])
+{
+	uint32_t const *k = g->ek;
+	uint32_t s0 = load_be32(src +  0) ^ k[0], s1 = load_be32(src +  4) ^ k[1];
+	uint32_t s2 = load_be32(src +  8) ^ k[2], s3 = load_be32(src + 12) ^ k[3];
+	for (size_t r = 1; r < g->rounds; ++r) {
+		k += 4;
+		uint32_t t0 = te[0][s0 >> 24] ^ te[1][s1 >> 16 & 0xff] ^ te[2][s2 >> 8 & 0xff] ^ te[3][s3 & 0xff] ^ k[0];
+		uint32_t t1 = te[0][s1 >> 24] ^ te[1][s2 >> 16 & 0xff] ^ te[2][s3 >> 8 & 0xff] ^ te[3][s0 & 0xff] ^ k[1];
+		uint32_t t2 = te[0][s2 >> 24] ^ te[1][s3 >> 16 & 0xff] ^ te[2][s0 >> 8 & 0xff] ^ te[3][s1 & 0xff] ^ k[2];
+		uint32_t t3 = te[0][s3 >> 24] ^ te[1][s0 >> 16 & 0xff] ^ te[2][s1 >> 8 & 0xff] ^ te[3][s2 & 0xff] ^ k[3];
+		s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+	}
+	k += 4;
+	store_be32(dst +  0, aes_subword((s0 & 0xff000000) | (s1 & 0xff0000) | (s2 & 0xff00) | (s3 & 0xff)) ^ k[0]);
+	store_be32(dst +  4, aes_subword((s1 & 0xff000000) | (s2 & 0xff0000) | (s3 & 0xff00) | (s0 & 0xff)) ^ k[1]);
+	store_be32(dst +  8, aes_subword((s2 & 0xff000000) | (s3 & 0xff0000) | (s0 & 0xff00) | (s1 & 0xff)) ^ k[2]);
+	store_be32(dst + 12, aes_subword((s3 & 0xff000000) | (s0 & 0xff0000) | (s1 & 0xff00) | (s2 & 0xff)) ^ k[3]);
+}
+
+/* reduction of the four bits shifted out per step */
+static uint64_t const ghashRem[16] = {
+	0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+	0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0,
+};
+
+/* y = y * H, with Shoup's 4-bit tables */
+static void
+ghash_mul(Gcm const *g, uint8_t y[16])
+{
+	uint64_t zh = 0, zl = 0;
+	for (int i = 15; i >= 0; --i)
+		for (int k = 0; k < 2; ++k) {
+			size_t nib = k ? y[i] >> 4 : y[i] & 15;
+			if (i != 15 || k) {
+				size_t rem = zl & 15;
+				zl = zh << 60 | zl >> 4;
+				zh = zh >> 4 ^ ghashRem[rem] << 48;
+			}
+			zh ^= g->hh[nib];
+			zl ^= g->hl[nib];
+		}
+	store_be64(y, zh);
+	store_be64(y + 8, zl);
+}
+
+/* the last block is zero padded */
+static void
+ghash_update(Gcm const *g, uint8_t y[16], uint8_t const *p, size_t n)
+{
+	for (; n; p += 16) {
+		size_t k = n < 16 ? n : 16;
+		for (size_t i = 0; i < k; ++i)
+			y[i] ^= p[i];
+		ghash_mul(g, y);
+		n -= k;
+	}
+}
+
+static void
+gcm_init(Gcm *g, uint8_t const *key, size_t keyLen)
+{
+	size_t nk = keyLen / 4;
+	g->rounds = nk + 6;
+	for (size_t i = 0; i < nk; ++i)
+		g->ek[i] = load_be32(key + 4*i);
+	uint8_t rcon = 1;
+	for (size_t i = nk; i < 4*(g->rounds+1); ++i) {
+		uint32_t t = g->ek[i-1];
+		if (i % nk == 0) {
+			t = aes_subword(ROR32(t, 24)) ^ (uint32_t)rcon << 24;
+			rcon = xtime(rcon);
+		} else if (nk > 6 && i % nk == 4) {
+			t = aes_subword(t);
+		}
+		g->ek[i] = g->ek[i-nk] ^ t;
+	}
+	for (size_t i = 0; i < 4*(g->rounds+1); ++i)
+		store_be32(g->rk[i/4] + i%4*4, g->ek[i]);
+
+	uint8_t h[16] = { 0 };
+	aes_encrypt(g, h, h);
+	uint64_t vh = load_be64(h), vl = load_be64(h + 8);
+	g->hh[0] = g->hl[0] = 0;
+	g->hh[8] = vh;
+	g->hl[8] = vl;
+	for (size_t i = 4; i > 0; i >>= 1) {
+		uint64_t t = (vl & 1) * 0xe1000000;
+		vl = vh << 63 | vl >> 1;
+		vh = vh >> 1 ^ t << 32;
+		g->hh[i] = vh;
+		g->hl[i] = vl;
+	}
+	for (size_t i = 2; i <= 8; i *= 2)
+		for (size_t j = 1; j < i; ++j) {
+			g->hh[i+j] = g->hh[i] ^ g->hh[j];
+			g->hl[i+j] = g->hl[i] ^ g->hl[j];
+		}
+
+	g->maxk = ARR_LEN(g->hpow);
+	memcpy(g->hpow[g->maxk-1], h, 16);
+	for (size_t i = g->maxk-1; i > 0; --i) {
+		memcpy(g->hpow[i-1], g->hpow[i], 16);
+		ghash_mul(g, g->hpow[i-1]);
+	}
+}
+
+/* The impls process whole blocks, in counter mode starting at ctr, and
+ * hash the ciphertext into y. The IV, AAD, last partial block and the
+ * length block are handled by gcm_crypt. */
+typedef void Blocks(Gcm const *g, uint8_t *dst, uint8_t const *src, size_t nblocks, uint8_t const ctr[16], uint8_t y[16]);
+
+static void
+gcm_ctr_add(uint8_t ctr[16], uint32_t n)
+{
+	store_be32(ctr + 12, load_be32(ctr + 12) + n);
+}
+
+void
+gcm_enc_scalar(Gcm const *g, uint8_t *dst, uint8_t const *src, size_t nblocks, uint8_t const ctr[16], uint8_t y[16])
+{
+	uint8_t c[16], ks[16];
+	memcpy(c, ctr, 16);
+	for (; nblocks--; src += 16, dst += 16) {
+		aes_encrypt(g, ks, c);
+		gcm_ctr_add(c, 1);
+		for (size_t i = 0; i < 16; ++i)
+			y[i] ^= dst[i] = src[i] ^ ks[i];
+		ghash_mul(g, y);
+	}
+}
+
+void
+gcm_dec_scalar(Gcm const *g, uint8_t *dst, uint8_t const *src, size_t nblocks, uint8_t const ctr[16], uint8_t y[16])
+{
+	uint8_t c[16], ks[16];
+	memcpy(c, ctr, 16);
+	for (; nblocks--; src += 16, dst += 16) {
+		aes_encrypt(g, ks, c);
+		gcm_ctr_add(c, 1);
+		for (size_t i = 0; i < 16; ++i) {
+			y[i] ^= src[i];
+			dst[i] = src[i] ^ ks[i];
+		}
+		ghash_mul(g, y);
+	}
+}
+
+/* encrypts and writes the tag, or decrypts and returns if the tag matches */
+static int
+gcm_crypt(Blocks *blocks, Gcm const *g, uint8_t *dst, uint8_t const *src, size_t n,
+          uint8_t const iv[12], uint8_t const *aad, size_t aadLen, uint8_t tag[16], int enc)
+{
+	uint8_t ctr[16], ek0[16], buf[16], y[16] = { 0 };
+	memcpy(ctr, iv, 12);
+	store_be32(ctr + 12, 1);
+	aes_encrypt(g, ek0, ctr);
+	ghash_update(g, y, aad, aadLen);
+
+	size_t nb = n / 16, r = n % 16;
+	gcm_ctr_add(ctr, 1);
+	if (nb)
+		blocks(g, dst, src, nb, ctr, y);
+	gcm_ctr_add(ctr, nb);
+	if (r) {
+		aes_encrypt(g, buf, ctr);
+		src += nb*16;
+		dst += nb*16;
+		for (size_t i = 0; i < r; ++i) {
+			uint8_t c = enc ? src[i] ^ buf[i] : src[i];
+			dst[i] = src[i] ^ buf[i];
+			y[i] ^= c;
+		}
+		ghash_mul(g, y);
+	}
+	store_be64(buf, (uint64_t)aadLen * 8);
+	store_be64(buf + 8, (uint64_t)n * 8);
+	ghash_update(g, y, buf, 16);
+
+	uint8_t diff = 0;
+	for (size_t i = 0; i < 16; ++i) {
+		if (enc)
+			tag[i] = y[i] ^ ek0[i];
+		else
+			diff |= tag[i] ^ y[i] ^ ek0[i];
+	}
+	return diff == 0;
+}
+
+#if __riscv_xlen != 32 && __riscv_v_elen >= 64 && \
+    __riscv_zvkned && __riscv_zvkg && (__riscv_zvkb || __riscv_zvbb)
+# define IMPLS_ZVK(f) f(rvv_m1) f(rvv_m2)
+#else
+# define IMPLS_ZVK(f)
+#endif
+
+#define IMPLS(f) \
+	f(scalar) \
+	IMPLS_ZVK(f) \
+
+typedef int Func(Gcm const *g, uint8_t *dst, uint8_t const *src, size_t n,
+                 uint8_t const iv[12], uint8_t const *aad, size_t aadLen, uint8_t tag[16], int enc);
+
+#define DECLARE(f) \
+	extern Blocks gcm_enc_##f, gcm_dec_##f; \
+	int gcm_##f(Gcm const *g, uint8_t *dst, uint8_t const *src, size_t n, \
+	            uint8_t const iv[12], uint8_t const *aad, size_t aadLen, uint8_t tag[16], int enc) { \
+		return gcm_crypt(enc ? gcm_enc_##f : gcm_dec_##f, g, dst, src, n, iv, aad, aadLen, tag, enc); \
+	}
+IMPLS(DECLARE)
+
+#define EXTRACT(f) { #f, &gcm_##f, 0 },
+Impl impls[] = { IMPLS(EXTRACT) };
+
+static Gcm gcm128, gcm256;
+/* a TLS 1.2 record header as AAD */
+static uint8_t iv[12], aad[13], tag[16];
+uint8_t *dest, *text, *sealed;
+ux last;
+
+void init(void) {
+	uint8_t key[32];
+	bench_memrand(key, sizeof key);
+	bench_memrand(iv, sizeof iv);
+	bench_memrand(aad, sizeof aad);
+	aes_tables();
+	gcm_init(&gcm128, key, 16);
+	gcm_init(&gcm256, key, 32);
+	dest = mem;
+	text = mem + MAX_MEM/2;
+	sealed = mem + MAX_MEM*3/4;
+}
+
+ux checksum(size_t n) {
+	return bench_hash(last, dest, n+16);
+}
+
+BENCH_BEG(enc128) {
+	memset(dest, 0, n+16);
+	TIME f(&gcm128, dest, text, n, iv, aad, sizeof aad, tag, 1);
+	last = bench_hash(0, tag, sizeof tag);
+} BENCH_END
+
+BENCH_BEG(enc256) {
+	memset(dest, 0, n+16);
+	TIME f(&gcm256, dest, text, n, iv, aad, sizeof aad, tag, 1);
+	last = bench_hash(0, tag, sizeof tag);
+} BENCH_END
+
+/* the ciphertext is sealed by the scalar impl, the tag check is timed */
+BENCH_BEG(dec128) {
+	gcm_scalar(&gcm128, sealed, text, n, iv, aad, sizeof aad, tag, 1);
+	memset(dest, 0, n+16);
+	TIME last = f(&gcm128, dest, sealed, n, iv, aad, sizeof aad, tag, 0);
+} BENCH_END
+
+BENCH_BEG(dec256) {
+	gcm_scalar(&gcm256, sealed, text, n, iv, aad, sizeof aad, tag, 1);
+	memset(dest, 0, n+16);
+	TIME last = f(&gcm256, dest, sealed, n, iv, aad, sizeof aad, tag, 0);
+} BENCH_END
+
+/* in place, to cover dst == src */
+GUARD_BEG(enc) {
+	f(&gcm128, p, p, n, iv, aad, sizeof aad, tag, 1);
+	return bench_hash(bench_hash(0, tag, sizeof tag), p, n);
+} GUARD_END
+
+GUARD_BEG(dec) {
+	return f(&gcm256, p, p, n, iv, aad, sizeof aad, tag, 0) + bench_hash(0, p, n);
+} GUARD_END
+
+Bench benches[] = {
+	BENCH( impls, 1024*256, "aes-128-gcm encrypt", bench_enc128, guard_enc ),
+	BENCH( impls, 1024*256, "aes-128-gcm decrypt", bench_dec128, guard_dec ),
+	BENCH( impls, 1024*256, "aes-256-gcm encrypt", bench_enc256 ),
+	BENCH( impls, 1024*256, "aes-256-gcm decrypt", bench_dec256 ),
+}; BENCH_MAIN(benches)
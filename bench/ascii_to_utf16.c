@@ -32,10 +32,7 @@ uint8_t *src;
 void init(void) { }
 
 ux checksum(size_t n) {
-	ux sum = 0;
-	for (size_t i = 0; i < n+9; ++i)
-		sum = uhash(sum) + dest[i];
-	return sum;
+	return bench_hash(0, dest, (n+9) * sizeof *dest);
 }
 
 void common(size_t n, size_t dOff, size_t sOff) {
@@ -56,8 +53,15 @@ BENCH_BEG(aligned) {
 	TIME f(dest, src, n);
 } BENCH_END
 
+GUARD_BEG(base) {
+	for (size_t i = 0; i < n; ++i) p[i] &= 0x7F;
+	memset(mem, 1, (n+9)*2);
+	f((uint16_t*)mem, p, n);
+	return bench_hash(0, mem, (n+9)*2);
+} GUARD_END
+
 Bench benches[] = {
-	BENCH( impls, MAX_MEM/3 - 512-9*2, "ascii to utf16", bench_base ),
+	BENCH( impls, MAX_MEM/3 - 512-9*2, "ascii to utf16", bench_base, guard_base ),
 	BENCH( impls, MAX_MEM/3 - 512-9*2, "ascii to utf16 aligned", bench_aligned ),
 }; BENCH_MAIN(benches)
 
@@ -0,0 +1,204 @@
+#include "bench.h"
+
+static int8_t base64Rev[256];
+
+size_t
+b64_decode_scalar(uint8_t *dst, const uint8_t *src, size_t length, const uint8_t LUTs[48])
+{
+	uint8_t *dstBeg = dst;
+	if (length % 4)
+		return -1;
+	size_t pad = 0;
+	if (length && src[length-1] == '=')
+		pad = 1 + (src[length-2] == '=');
+	for (; length > 4 || (length == 4 && !pad); length -= 4, src += 4, dst += 3) {
+		int32_t a = base64Rev[src[0]], b = base64Rev[src[1]];
+		int32_t c = base64Rev[src[2]], d = base64Rev[src[3]];
+		if ((a | b | c | d) < 0)
+			return -1;
+		uint32_t u32 = a << 18 | b << 12 | c << 6 | d;
+		dst[0] = u32 >> 16;
+		dst[1] = u32 >>  8;
+		dst[2] = u32 >>  0;
+	}
+	if (pad) {
+		int32_t a = base64Rev[src[0]], b = base64Rev[src[1]];
+		int32_t c = pad == 1 ? base64Rev[src[2]] : 0;
+		if ((a | b | c) < 0)
+			return -1;
+		uint32_t u32 = a << 18 | b << 12 | c << 6;
+		*dst++ = u32 >> 16;
+		if (pad == 1)
+			*dst++ = u32 >> 8;
+	}
+	return dst - dstBeg;
+}
+
+/* Nibble lookup tables: a char is invalid, if lo[c & 15] & hi[c >> 4] is
+ * non-zero, and its value is c + roll[(c >> 4) - (c == '/')].
+ * See: http://0x80.pl/notesen/2016-01-17-sse-base64-decoding.html */
+static uint8_t base64DecLUTs[48] = {
+	0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+	0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a,
+	0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0, 16, 19, 4, (uint8_t)-65, (uint8_t)-65, (uint8_t)-71, (uint8_t)-71,
+	0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+/* handles the last, possibly padded, quad of vectorized implementations */
+size_t
+b64_decode_scalar_tail(size_t prefix, uint8_t *dst, const uint8_t *src, size_t length)
+{
+	size_t len = b64_decode_scalar(dst, src, length, base64DecLUTs);
+	return len == (size_t)-1 ? len : prefix + len;
+}
+
+/* removes ' ', '\t', '\n', '\v', '\f' and '\r' */
+size_t
+b64_skip_ws_scalar(uint8_t *dst, const uint8_t *src, size_t length)
+{
+	uint8_t *d = dst;
+	for (; length--; ++src)
+		if (*src != ' ' && (uint8_t)(*src - 9) > 4)
+			*d++ = *src;
+	return d - dst;
+}
+
+typedef size_t Func(uint8_t *dst, const uint8_t *src, size_t length, const uint8_t LUTs[48]);
+typedef size_t Skip(uint8_t *dst, const uint8_t *src, size_t length);
+
+#define WS_CHUNK 1024
+
+/* Whitespace tolerant decoding, chunks of the input are compacted into a
+ * buffer, and decoded with the strict decoder. Only the last quad may be
+ * padded, so data after a padded chunk is an error. */
+static size_t
+b64_decode_ws(Func *decode, Skip *skip, uint8_t *dst, const uint8_t *src, size_t length, const uint8_t LUTs[48])
+{
+	uint8_t buf[WS_CHUNK + 4];
+	size_t have = 0, total = 0;
+	int padded = 0;
+	while (length) {
+		size_t k = length < WS_CHUNK ? length : WS_CHUNK;
+		have += skip(buf + have, src, k);
+		src += k; length -= k;
+		size_t use = length ? have & -4 : have;
+		if (!use)
+			continue;
+		if (padded)
+			return -1;
+		size_t len = decode(dst + total, buf, use, LUTs);
+		if (len == (size_t)-1)
+			return len;
+		padded = len != use / 4 * 3;
+		total += len;
+		have -= use;
+		memcpy(buf, buf + use, have);
+	}
+	return have ? (size_t)-1 : total;
+}
+
+#define IMPLS(f) \
+	f(scalar) \
+	f(rvv_seg_m1) f(rvv_seg_m2) \
+	f(rvv_compress_m1) f(rvv_compress_m2) f(rvv_compress_m4) \
+
+#define IMPLS_WS(f) \
+	f(scalar, scalar) \
+	f(rvv_seg_m1, rvv_m1) f(rvv_seg_m2, rvv_m2) \
+	f(rvv_compress_m1, rvv_m1) f(rvv_compress_m2, rvv_m2) \
+	f(rvv_compress_m4, rvv_m4) \
+
+#define DECLARE(f) extern Func b64_decode_##f;
+IMPLS(DECLARE)
+
+#define DECLARE_WS(f,s) \
+	extern Skip b64_skip_ws_##s; \
+	size_t b64_decode_##f##_ws(uint8_t *dst, const uint8_t *src, size_t length, const uint8_t LUTs[48]) { \
+		return b64_decode_ws(b64_decode_##f, b64_skip_ws_##s, dst, src, length, LUTs); \
+	}
+IMPLS_WS(DECLARE_WS)
+
+#define EXTRACT(f) { #f, &b64_decode_##f, 0 },
+Impl impls[] = { IMPLS(EXTRACT) };
+
+#define EXTRACT_WS(f,s) { #f "_ws", &b64_decode_##f##_ws, 0 },
+Impl implsWs[] = { IMPLS_WS(EXTRACT_WS) };
+
+static uint8_t base64LUT[64] =
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+	"abcdefghijklmnopqrstuvwxyz"
+	"0123456789"
+	"+/";
+
+/* MIME style line length */
+#define LINE 76
+
+uint8_t *dest, *text, *textWs;
+size_t textLen, textWsLen;
+size_t last;
+
+void init(void) {
+	for (size_t i = 0; i < 256; ++i)
+		base64Rev[i] = -1;
+	for (size_t i = 0; i < 64; ++i)
+		base64Rev[base64LUT[i]] = i;
+
+	text = mem;
+	textWs = mem + MAX_MEM/3;
+	dest = mem + MAX_MEM*3/4;
+	textLen = MAX_MEM/4 & -4;
+	for (size_t i = 0; i < textLen; ++i)
+		text[i] = base64LUT[mem[i] & 63];
+	for (size_t i = 0; i < textLen; ++i) {
+		if (i && i % LINE == 0)
+			textWs[textWsLen++] = '\r', textWs[textWsLen++] = '\n';
+		textWs[textWsLen++] = text[i];
+	}
+}
+
+ux checksum(size_t n) {
+	return last == (size_t)-1 ? last : bench_hash(last, dest, last+9);
+}
+
+BENCH_BEG(base) {
+	memset(dest, 0, n+9);
+	TIME last = f(dest, text, n & -4, base64DecLUTs);
+} BENCH_END
+
+/* the prefix is shortened, so it holds a multiple of four chars */
+BENCH_BEG(ws) {
+	size_t chars = n / (LINE+2) * LINE + (n % (LINE+2) < LINE ? n % (LINE+2) : LINE);
+	size_t len = n - (n % (LINE+2) > LINE ? n % (LINE+2) - LINE : 0) - chars % 4;
+	memset(dest, 0, n+9);
+	TIME last = f(dest, textWs, len, base64DecLUTs);
+} BENCH_END
+
+/* one char is replaced by a random invalid one, which isn't '=', because
+ * that could be valid padding at the end */
+BENCH_BEG(invalid) {
+	uint8_t c, *p = text + (n >= 4 ? bench_urand() % (n & -4) : 0), save = *p;
+	do c = bench_urand(); while (base64Rev[c] >= 0 || c == '=');
+	if (n >= 4)
+		*p = c;
+	memset(dest, 0, n+9);
+	TIME last = f(dest, text, n & -4, base64DecLUTs);
+	*p = save;
+} BENCH_END
+
+/* valid chars, random lengths also cover errors from missing padding */
+GUARD_BEG(base) {
+	for (size_t i = 0; i < n; ++i)
+		p[i] = base64LUT[p[i] & 63];
+	memset(mem, 0, n+9);
+	size_t len = f(mem, p, n, base64DecLUTs);
+	return len == (size_t)-1 ? len : bench_hash(len, mem, len+9);
+} GUARD_END
+
+Bench benches[] = {
+	BENCH( impls, MAX_MEM/4, "base64 decode", bench_base, guard_base ),
+	BENCH( impls, MAX_MEM/4, "base64 decode invalid", bench_invalid ),
+	BENCH( implsWs, MAX_MEM/4, "base64 decode whitespace", bench_ws ),
+}; BENCH_MAIN(benches)
+
@@ -57,10 +57,7 @@ size_t last;
 void init(void) { }
 
 ux checksum(size_t n) {
-	ux sum = last;
-	for (size_t i = 0; i < last+9; ++i)
-		sum = uhash(sum) + dest[i];
-	return sum;
+	return bench_hash(last, dest, last+9);
 }
 
 BENCH_BEG(base) {
@@ -70,7 +67,13 @@ BENCH_BEG(base) {
 	TIME last = f(dest, src, n, base64LUTs);
 } BENCH_END
 
+GUARD_BEG(base) {
+	memset(mem, 0, n*2+9);
+	size_t len = f(mem, p, n, base64LUTs);
+	return bench_hash(len, mem, len+9);
+} GUARD_END
+
 Bench benches[] = {
-	BENCH( impls, MAX_MEM/3, "base64 encode", bench_base ),
+	BENCH( impls, MAX_MEM/3, "base64 encode", bench_base, guard_base ),
 }; BENCH_MAIN(benches)
 
@@ -38,22 +38,142 @@ compare_ux(void const *a, void const *b)
 	return A < B ? -1 : A > B ? 1 : 0;
 }
 
+static int
+compare_fx(void const *a, void const *b)
+{
+	fx A = *(fx*)a, B = *(fx*)b;
+	return A < B ? -1 : A > B ? 1 : 0;
+}
+
 static URand randState = { 123, 456, 789 };
 static ux bench_urand(void) { return urand(&randState); }
 static float bench_urandf(void) { return urandf(&randState); }
+
+#ifdef __riscv_vector
+/* Counter based RNG, word i is fmix32(seed + i). The scalar memrand is so
+ * slow on in-order cores and under qemu, that the setup dominates runtime. */
+static void
+bench_memrand(void *ptr, size_t n)
+{
+	unsigned char *p = (unsigned char*)ptr;
+	uint32_t seed = bench_urand();
+	for (; n && (uintptr_t)p % 4; --n) *p++ = bench_urand();
+	size_t words = n / 4, vl, tmp;
+	if (words) __asm__ volatile (
+		"vsetvli %[vl], zero, e32, m4, ta, ma\n"
+		"vid.v v8\n"
+		"vadd.vx v8, v8, %[seed]\n"
+		"1:\n"
+		"vsetvli %[vl], %[words], e32, m4, ta, ma\n"
+		"vsrl.vi v12, v8, 16\n"
+		"vxor.vv v12, v12, v8\n"
+		"vmul.vx v12, v12, %[c1]\n"
+		"vsrl.vi v16, v12, 13\n"
+		"vxor.vv v12, v12, v16\n"
+		"vmul.vx v12, v12, %[c2]\n"
+		"vsrl.vi v16, v12, 16\n"
+		"vxor.vv v12, v12, v16\n"
+		"vse32.v v12, (%[p])\n"
+		"vadd.vx v8, v8, %[vl]\n"
+		"sub %[words], %[words], %[vl]\n"
+		"slli %[tmp], %[vl], 2\n"
+		"add %[p], %[p], %[tmp]\n"
+		"bnez %[words], 1b\n"
+		: [p]"+r"(p), [words]"+r"(words), [vl]"=&r"(vl), [tmp]"=&r"(tmp)
+		: [seed]"r"(seed), [c1]"r"(0x85ebca6b), [c2]"r"(0xc2b2ae35)
+		: SYSCALL_CLOBBERS);
+	for (n %= 4; n--; ) *p++ = bench_urand();
+}
+
+/* Multi-lane FNV-1a over 32-bit words, each lane is finalized with fmix32
+ * and xor reduced. The result depends on VLEN, so it's only comparable
+ * within the same process, which is all checksum() needs. */
+static ux
+bench_hash(ux seed, void const *ptr, size_t n)
+{
+	unsigned char const *p = (unsigned char const*)ptr;
+	size_t words = n / 4, vl, bytes;
+	ux sum = seed;
+	if (words) {
+		uint32_t h;
+		__asm__ volatile (
+			"vsetvli %[vl], zero, e32, m4, ta, ma\n"
+			"vid.v v8\n"
+			"vmul.vx v8, v8, %[c1]\n"
+			"vadd.vx v8, v8, %[seed]\n"
+			"1:\n"
+			"vsetvli %[vl], %[words], e32, m4, tu, ma\n"
+			"slli %[bytes], %[vl], 2\n"
+			"vsetvli zero, %[bytes], e8, m4, ta, ma\n"
+			"vle8.v v16, (%[p])\n"
+			"vsetvli zero, %[vl], e32, m4, tu, ma\n"
+			"vxor.vv v8, v8, v16\n"
+			"vmul.vx v8, v8, %[prime]\n"
+			"add %[p], %[p], %[bytes]\n"
+			"sub %[words], %[words], %[vl]\n"
+			"bnez %[words], 1b\n"
+			"vsetvli %[vl], zero, e32, m4, ta, ma\n"
+			"vsrl.vi v16, v8, 16\n"
+			"vxor.vv v8, v8, v16\n"
+			"vmul.vx v8, v8, %[c1]\n"
+			"vsrl.vi v16, v8, 13\n"
+			"vxor.vv v8, v8, v16\n"
+			"vmul.vx v8, v8, %[c2]\n"
+			"vsrl.vi v16, v8, 16\n"
+			"vxor.vv v8, v8, v16\n"
+			"vmv.s.x v16, zero\n"
+			"vredxor.vs v16, v8, v16\n"
+			"vmv.x.s %[h], v16\n"
+			: [p]"+r"(p), [words]"+r"(words), [vl]"=&r"(vl),
+			  [bytes]"=&r"(bytes), [h]"=r"(h)
+			: [seed]"r"(seed), [prime]"r"(0x01000193),
+			  [c1]"r"(0x85ebca6b), [c2]"r"(0xc2b2ae35)
+			: SYSCALL_CLOBBERS);
+		sum = uhash(sum ^ h);
+	}
+	for (n %= 4; n--; )
+		sum = uhash(sum) + *p++;
+	return sum;
+}
+#else
 static void bench_memrand(void *ptr, size_t n) { return memrand(&randState, ptr, n); }
 
+static ux
+bench_hash(ux seed, void const *ptr, size_t n)
+{
+	unsigned char const *p = (unsigned char const*)ptr;
+	ux sum = seed;
+	while (n--)
+		sum = uhash(sum) + *p++;
+	return sum;
+}
+#endif
+
 typedef struct {
 	char const *name; void *func; int skipCheck;
 } Impl;
+/* a single call of a replayed sequence, offsets are relative to mem for
+ * the destination and mem+MAX_MEM/2 for the source, see REPLAY */
+typedef struct {
+	size_t n, dOff, sOff;
+} ReplayCall;
 typedef struct {
 	Impl *impls;
 	size_t nImpls;
 	size_t N;
 	char const *name;
 	ux (*func)(void *, size_t);
+	/* optional, calls the impl on the n bytes input at p and returns a
+	 * checksum of the result, see GUARD_CHECK */
+	ux (*guard)(void *func, unsigned char *p, size_t n);
+	/* optional, calls the impl for every call and returns the cycles */
+	ux (*replay)(void *func, ReplayCall const *calls, size_t nCalls);
+	/* optional, number of impl calls per timed region, on n bytes each */
+	size_t calls;
 } Bench;
 
+#define BENCH_CALLS(b) ((b)->calls ? (b)->calls : 1)
+
 static unsigned char *mem = 0;
 
 void bench_main(void);
@@ -68,6 +188,30 @@ static unsigned char heap[1 + MAX_MEM + MEM_ALIGN];
 #endif
 
 
+/* time CSR ticks accumulated by TIME */
+static ux bench_ticks;
+/* time CSR frequency in Hz, 0 if unknown */
+static fx bench_timebase;
+
+static fx
+bench_read_timebase(void)
+{
+#if TIMEBASE_FREQ
+	return TIMEBASE_FREQ;
+#elif __STDC_HOSTED__ && !defined(CUSTOM_HOST)
+	/* stored as big endian u32 */
+	unsigned char b[4];
+	FILE *f = fopen("/proc/device-tree/cpus/timebase-frequency", "rb");
+	if (!f) return 0;
+	size_t len = fread(b, 1, sizeof b, f);
+	fclose(f);
+	if (len != sizeof b) return 0;
+	return (uint32_t)b[0] << 24 | (uint32_t)b[1] << 16 | b[2] << 8 | b[3];
+#else
+	return 0;
+#endif
+}
+
 int
 main(void)
 {
@@ -85,6 +229,7 @@ main(void)
 
 	/* initialize memory */
 	bench_memrand(mem, MAX_MEM);
+	bench_timebase = bench_read_timebase();
 
 	init();
 	bench_main();
@@ -94,16 +239,51 @@ main(void)
 	return 0;
 }
 
-static fx
-bench_time(size_t n, Impl impl, Bench bench)
+typedef struct {
+	fx bpc; /* bytes per cycle */
+	fx mhz; /* effective frequency while timing, 0 if unknown */
+	size_t dropped; /* samples dropped because of frequency drift */
+} BenchRes;
+
+/* Drops samples whose cycles/time ratio deviates more than DRIFT_MAX from
+ * the median ratio, which happens on DVFS, throttling or core migration.
+ * Only samples spanning at least DRIFT_MIN_TICKS are checked, because of
+ * the coarse resolution of the time CSR. */
+static size_t
+bench_drop_drift(ux *cycles, ux *ticks, size_t repeats, size_t *dropped)
 {
-	static ux arr[MAX_REPEATS];
-	size_t total = 0, repeats = 0;
-	for (; repeats < MAX_REPEATS; ++repeats) {
-		total += arr[repeats] = bench.func(impl.func, n);
-		if (repeats > MIN_REPEATS && total > STOP_CYCLES)
-			break;
+	static fx ratios[MAX_REPEATS];
+	size_t nRatios = 0;
+	for (size_t i = 0; i < repeats; ++i)
+		if (ticks[i] >= DRIFT_MIN_TICKS)
+			ratios[nRatios++] = (fx)cycles[i] / ticks[i];
+	*dropped = 0;
+	if (nRatios < 3)
+		return repeats;
+
+	qsort(ratios, nRatios, sizeof *ratios, compare_fx);
+	fx median = ratios[nRatios/2];
+	fx lo = median * (1 - DRIFT_MAX), hi = median * (1 + DRIFT_MAX);
+
+	size_t kept = 0;
+	for (size_t i = 0; i < repeats; ++i) {
+		if (ticks[i] >= DRIFT_MIN_TICKS &&
+		    ((fx)cycles[i] < lo * ticks[i] || (fx)cycles[i] > hi * ticks[i])) {
+			++*dropped;
+			continue;
+		}
+		cycles[kept] = cycles[i];
+		ticks[kept++] = ticks[i];
 	}
+	return kept;
+}
+
+static BenchRes
+bench_stats(size_t n, ux *arr, ux *ticks, size_t repeats)
+{
+	BenchRes res = { 0 };
+	repeats = bench_drop_drift(arr, ticks, repeats, &res.dropped);
+
 #if MAX_REPEATS > 4
 	qsort(arr, repeats, sizeof *arr, compare_ux);
 	ux sum = 0, count = 0;
@@ -114,67 +294,526 @@ bench_time(size_t n, Impl impl, Bench bench)
 	for (size_t i = 0; i < repeats; ++i)
 		sum += arr[i];
 #endif
-	return n / ((fx)sum / count);
+	res.bpc = n / ((fx)sum / count);
+	return res;
+}
+
+/* The time CSR ticks too slowly to time short samples, and reading it may
+ * even trap, so the frequency is measured over all repetitions instead. */
+static fx
+bench_mhz(ux cycles, ux ticks)
+{
+	if (!ticks || !bench_timebase)
+		return 0;
+	return (fx)cycles / ticks * bench_timebase / 1000000;
+}
+
+static BenchRes
+bench_time(size_t n, Impl impl, Bench bench)
+{
+	static ux arr[MAX_REPEATS], ticks[MAX_REPEATS];
+	size_t total = 0, repeats = 0;
+	ux t0 = rv_time(), c0 = rv_cycles();
+	for (; repeats < MAX_REPEATS; ++repeats) {
+		bench_ticks = 0;
+		total += arr[repeats] = bench.func(impl.func, n);
+		ticks[repeats] = bench_ticks;
+		if (repeats > MIN_REPEATS && total > STOP_CYCLES)
+			break;
+	}
+	ux c1 = rv_cycles(), t1 = rv_time();
+	BenchRes res = bench_stats(n * BENCH_CALLS(&bench), arr, ticks, repeats);
+	res.mhz = bench_mhz(c1 - c0, t1 - t0);
+	return res;
+}
+
+static void
+bench_validate(size_t n, size_t s, Impl *i, Bench *b)
+{
+#if VALIDATE
+	ux si = 0, s0 = 0;
+	if (i != b->impls && !i->skipCheck && s % VALIDATE_EVERY == 0) {
+		URand seed = randState;
+		(void)b->func(i->func, n);
+		si = checksum(n);
+
+		randState = seed;
+		(void)b->func(b->impls[0].func, n);
+		s0 = checksum(n);
+	}
+
+	if (si != s0) {
+		print("ERROR: ")(s,i->name)(" in ")(s,b->name)(" at ")(u,n)(flush,);
+		exit(EXIT_FAILURE);
+	}
+#endif
+}
+
+#define BENCH_MAX_IMPLS 64
+#define BENCH_MAX_SIZES 256
+static BenchRes benchRes[BENCH_MAX_IMPLS][BENCH_MAX_SIZES];
+
+/* Runs the impls in a freshly shuffled order for every repetition, so slow
+ * drift (thermal, background daemons, page-cache state) spreads evenly over
+ * all impls, instead of turning into a systematic bias between them. */
+static void
+bench_time_interleaved(size_t n, BenchRes res[][BENCH_MAX_SIZES], size_t s, Bench *b)
+{
+	static ux arr[BENCH_MAX_IMPLS][MAX_REPEATS];
+	static ux ticks[BENCH_MAX_IMPLS][MAX_REPEATS];
+	static size_t order[BENCH_MAX_IMPLS];
+	/* the sum over all impls would overflow a 32-bit ux */
+	uint64_t total = 0;
+	size_t repeats = 0;
+	for (size_t i = 0; i < b->nImpls; ++i)
+		order[i] = i;
+
+	ux t0 = rv_time(), c0 = rv_cycles();
+	for (; repeats < MAX_REPEATS; ++repeats) {
+		for (size_t i = b->nImpls; i > 1; --i) {
+			size_t j = bench_urand() % i, tmp = order[i-1];
+			order[i-1] = order[j];
+			order[j] = tmp;
+		}
+		for (size_t k = 0; k < b->nImpls; ++k) {
+			size_t i = order[k];
+			bench_ticks = 0;
+			total += arr[i][repeats] = b->func(b->impls[i].func, n);
+			ticks[i][repeats] = bench_ticks;
+		}
+		if (repeats > MIN_REPEATS && total / b->nImpls > STOP_CYCLES)
+			break;
+	}
+	ux c1 = rv_cycles(), t1 = rv_time();
+
+	for (size_t i = 0; i < b->nImpls; ++i) {
+		res[i][s] = bench_stats(n * BENCH_CALLS(b), arr[i], ticks[i], repeats);
+		res[i][s].mhz = bench_mhz(c1 - c0, t1 - t0);
+	}
 }
 
 static void
 bench_run(Bench *benches, size_t nBenches)
 {
 	for (Bench *b = benches; b != benches + nBenches; ++b) {
+		if (b->nImpls > BENCH_MAX_IMPLS) {
+			print("ERROR: too many impls in ")(s,b->name)(flush,);
+			exit(EXIT_FAILURE);
+		}
+
 		print("{\ntitle: \"")(s,b->name)("\",\n");
 		print("labels: [\"0\",");
 		for (size_t i = 0; i < b->nImpls; ++i)
 			print("\"")(s,b->impls[i].name)("\",");
 		print("],\n");
 
-		size_t N = b->N;
+		size_t N = b->N, nSizes = 0;
 		print("data: [\n[");
-		for (size_t n = 1; n < N; n = BENCH_NEXT(n))
-			print(u,n)(",");
+		for (size_t n = 1; n < N && nSizes < BENCH_MAX_SIZES; n = BENCH_NEXT(n))
+			print(u,n)(","), ++nSizes;
 		print("],\n")(flush,);
 
-		for (Impl *i = b->impls; i != b->impls + b->nImpls; ++i) {
+#if INTERLEAVE
+		for (size_t n = 1, s = 0; s < nSizes; n = BENCH_NEXT(n), ++s) {
+			for (size_t i = 0; i < b->nImpls; ++i)
+				bench_validate(n, s, b->impls + i, b);
+			bench_time_interleaved(n, benchRes, s, b);
+		}
+		for (size_t i = 0; i < b->nImpls; ++i) {
 			print("[");
-			for (size_t n = 1; n < N; n = BENCH_NEXT(n)) {
-#if VALIDATE
-				ux si = 0, s0 = 0;
-				if (i != b->impls && !i->skipCheck) {
-					URand seed = randState;
-					(void)b->func(i->func, n);
-					si = checksum(n);
-
-					randState = seed;
-					(void)b->func(b->impls[0].func, n);
-					s0 = checksum(n);
-				}
-
-				if (si != s0) {
-					print("ERROR: ")(s,i->name)(" in ")(s,b->name)(" at ")(u,n)(flush,);
-					exit(EXIT_FAILURE);
-				}
+			for (size_t s = 0; s < nSizes; ++s)
+				print(f,benchRes[i][s].bpc)(",");
+			print("],\n")(flush,);
+		}
+#else
+		for (size_t i = 0; i < b->nImpls; ++i) {
+			Impl *impl = b->impls + i;
+			print("[");
+			for (size_t n = 1, s = 0; s < nSizes; n = BENCH_NEXT(n), ++s) {
+				bench_validate(n, s, impl, b);
+				benchRes[i][s] = bench_time(n, *impl, *b);
+				print(f,benchRes[i][s].bpc)(",")(flush,);
+			}
+			print("],\n")(flush,);
+		}
 #endif
+		print("],\n");
 
-				print(f,bench_time(n, *i, *b))(",")(flush,);
+		/* bytes per ns and effective MHz, to detect frequency changes */
+		print("ns: [\n");
+		for (size_t i = 0; i < b->nImpls; ++i) {
+			print("[");
+			for (size_t s = 0; s < nSizes; ++s)
+				print(f,benchRes[i][s].bpc * benchRes[i][s].mhz / 1000)(",");
+			print("],\n");
+		}
+		print("],\nmhz: [\n");
+		for (size_t i = 0; i < b->nImpls; ++i) {
+			print("[");
+			for (size_t s = 0; s < nSizes; ++s)
+				print(fn,1,benchRes[i][s].mhz)(",");
+			print("],\n");
+		}
+		if (b->calls) {
+			print("],\ncycles_per_call: [\n");
+			for (size_t i = 0; i < b->nImpls; ++i) {
+				print("[");
+				for (size_t n = 1, s = 0; s < nSizes; n = BENCH_NEXT(n), ++s)
+					print(f,n / benchRes[i][s].bpc)(",");
+				print("],\n");
 			}
-			print("],\n")(flush,);
 		}
-		print("]\n},\n");
+		print("],\ndropped: [");
+		for (size_t i = 0; i < b->nImpls; ++i) {
+			size_t dropped = 0;
+			for (size_t s = 0; s < nSizes; ++s)
+				dropped += benchRes[i][s].dropped;
+			print(u,dropped)(",");
+		}
+		print("]\n},\n")(flush,);
 	}
 }
 
 #define TIME \
-	for (ux beg = rv_cycles(), _once = 1; _once; \
-	       _cycles += rv_cycles() - beg, _once = 0)
+	for (ux tbeg = rv_time(), beg = rv_cycles(), _once = 1; _once; \
+	       _cycles += rv_cycles() - beg, bench_ticks += rv_time() - tbeg, \
+	       _once = 0)
 
 #define BENCH_BEG(name) \
 	ux bench_##name(void *_func, size_t n) { \
 		Func *f = _func; ux _cycles = 0;
 #define BENCH_END return _cycles; }
 
-#define BENCH(impls, ...) { impls, ARR_LEN(impls), __VA_ARGS__ }
+#define GUARD_BEG(name) \
+	ux guard_##name(void *_func, unsigned char *p, size_t n) { \
+		Func *f = _func;
+#define GUARD_END }
+
+/* The replayed calls write their output to mem + dOff, and a scalar result,
+ * like a length, goes to replayResult. Both are validated. */
+static ux replayResult;
+
+#define REPLAY_BEG(name) \
+	ux replay_##name(void *_func, ReplayCall const *calls, size_t nCalls) { \
+		Func *f = _func; ux _cycles = 0;
+#define REPLAY_END return _cycles; }
+
+#define BENCH(i, ...) { .impls = i, .nImpls = ARR_LEN(i), __VA_ARGS__ }
+
+#if GUARD_CHECK
+#if !__STDC_HOSTED__ || defined(CUSTOM_HOST)
+# error "GUARD_CHECK requires a hosted environment"
+#endif
+#include <setjmp.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static sigjmp_buf guardJmp;
+static void guard_handler(int sig) { siglongjmp(guardJmp, sig); }
+
+#define GUARD_ALIGN 64
+
+static void
+guard_print_place(int atEnd, size_t off)
+{
+	if (atEnd)
+		print(" (end)\n")(flush,);
+	else
+		print(" (start+")(u,off)(")\n")(flush,);
+}
+
+/* Places the input flush against PROT_NONE guard pages, either starting
+ * right after one, or ending right before one, and runs every impl at
+ * random sizes on it. This catches over-reading impls, that only pass the
+ * regular benchmarks, because reading past the input is harmless there.
+ * The start is offset by up to GUARD_ALIGN-1 bytes from the guard page, so
+ * it takes every alignment, like the end does with the random sizes. */
+static void
+bench_guard(Bench *benches, size_t nBenches)
+{
+	size_t page = sysconf(_SC_PAGESIZE);
+	size_t size = (GUARD_MEM + page-1) & -page;
+	unsigned char *map = mmap(0, size + 2*page, PROT_READ | PROT_WRITE,
+	                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (map == MAP_FAILED ||
+	    mprotect(map, page, PROT_NONE) ||
+	    mprotect(map + page + size, page, PROT_NONE)) {
+		print("ERROR: failed to map guard pages")(flush,);
+		exit(EXIT_FAILURE);
+	}
+	unsigned char *beg = map + page, *end = beg + size;
+
+	struct sigaction sa = {0};
+	sa.sa_handler = guard_handler;
+	sigaction(SIGSEGV, &sa, 0);
+	sigaction(SIGBUS, &sa, 0);
+
+	size_t failed = 0;
+	for (Bench *b = benches; b != benches + nBenches; ++b) {
+		if (!b->guard)
+			continue;
+		print("{\ntitle: \"")(s,b->name)(" guard\",\n");
+		print("labels: [");
+		for (size_t i = 0; i < b->nImpls; ++i)
+			print("\"")(s,b->impls[i].name)("\",");
+		print("],\nfaults: [")(flush,);
+
+		for (Impl *i = b->impls; i != b->impls + b->nImpls; ++i) {
+			size_t faults = 0;
+			for (size_t r = 0; r < GUARD_RUNS; ++r) {
+				/* biased towards small sizes */
+				size_t off = r & 1 ? 0 : bench_urand() % GUARD_ALIGN;
+				size_t n = bench_urand() % (bench_urand() % (size - off) + 1);
+				unsigned char *p = r & 1 ? end - n : beg + off;
+
+				URand seed = randState;
+				bench_memrand(p, n);
+				int sig = sigsetjmp(guardJmp, 1);
+				if (sig) {
+					print("\nERROR: ")(s,i->name)(" faulted at n=")(u,n);
+					guard_print_place(r & 1, off);
+					++faults;
+					continue;
+				}
+				ux si = b->guard(i->func, p, n);
+				if (i == b->impls || i->skipCheck)
+					continue;
+
+				randState = seed;
+				bench_memrand(p, n);
+				ux s0 = b->guard(b->impls[0].func, p, n);
+				if (si != s0) {
+					print("\nERROR: ")(s,i->name)(" mismatch at n=")(u,n);
+					guard_print_place(r & 1, off);
+					++faults;
+				}
+			}
+			failed += faults;
+			print(u,faults)(",")(flush,);
+		}
+		print("]\n},\n")(flush,);
+	}
+	munmap(map, size + 2*page);
+	if (failed)
+		exit(EXIT_FAILURE);
+}
+# define BENCH_RUN bench_guard
+#elif REPLAY
+#if REPLAY == 2 && defined(CUSTOM_HOST)
+# error "REPLAY 2 reads from stdin, which CUSTOM_HOST doesn't provide"
+#endif
+
+#define REPLAY_ALIGN 64
+#define REPLAY_MAX_ENTRIES (1024*64)
+
+/* weight is cumulative, an align of REPLAY_ALIGN means random */
+typedef struct {
+	size_t n, dAlign, sAlign;
+	ux weight;
+} ReplayEntry;
+
+static ReplayEntry replayTable[REPLAY_MAX_ENTRIES];
+static size_t replayEntries, replayMin = -1;
+static ReplayCall replayCalls[REPLAY_CALLS];
+static Bench *replayBench;
+
+#if REPLAY == 2
+static int
+replay_getc(void)
+{
+	static char buf[4096];
+	static size_t i, len;
+	if (i == len && !(i = 0, len = memread(buf, sizeof buf)))
+		return -1;
+	return buf[i++];
+}
+
+/* Reads "size [count [dest_align [src_align]]]" lines, so both a histogram
+ * and a raw trace with one size per line work, '#' starts a comment. */
+static void
+replay_load(void)
+{
+	int c = replay_getc();
+	while (c >= 0) {
+		ux v[4] = { 0, 1, REPLAY_ALIGN, REPLAY_ALIGN };
+		size_t k = 0;
+		while (c >= 0 && c != '\n') {
+			if (c == '#') {
+				while ((c = replay_getc()) >= 0 && c != '\n');
+				break;
+			}
+			if (c < '0' || c > '9') {
+				c = replay_getc();
+				continue;
+			}
+			ux x = 0;
+			for (; c >= '0' && c <= '9'; c = replay_getc())
+				x = x*10 + c - '0';
+			if (k < 4)
+				v[k] = k >= 2 ? x % REPLAY_ALIGN : x, ++k;
+		}
+		c = replay_getc();
+		if (!k || !v[1])
+			continue;
+		if (replayEntries == REPLAY_MAX_ENTRIES) {
+			print("ERROR: more than ")(u,REPLAY_MAX_ENTRIES);
+			print(" replay entries, use a histogram")(flush,);
+			exit(EXIT_FAILURE);
+		}
+		ReplayEntry *e = replayTable + replayEntries;
+		e->n = v[0];
+		e->weight = v[1] + (replayEntries ? e[-1].weight : 0);
+		e->dAlign = v[2];
+		e->sAlign = v[3];
+		if (e->n < replayMin)
+			replayMin = e->n;
+		++replayEntries;
+	}
+}
+#endif
+
+static void
+replay_sample(ReplayCall *c)
+{
+#if REPLAY == 1
+	/* heavy-tailed, half of the calls are below 8 bytes, but the few
+	 * calls of up to 128K bytes dominate the total byte count */
+	size_t b = 0;
+	while (b < 16 && bench_urandf() < 0.7f)
+		++b;
+	c->n = ((size_t)1 << b) - 1 + bench_urand() % ((size_t)1 << b);
+	c->dOff = c->sOff = REPLAY_ALIGN;
+#else
+	ux r = bench_urand() % replayTable[replayEntries-1].weight;
+	size_t lo = 0, hi = replayEntries - 1;
+	while (lo < hi) {
+		size_t mid = (lo + hi) / 2;
+		if (replayTable[mid].weight > r)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+	c->n = replayTable[lo].n;
+	c->dOff = replayTable[lo].dAlign;
+	c->sOff = replayTable[lo].sAlign;
+#endif
+}
+
+/* Places the calls consecutively, without overlap, because the impls may
+ * depend on the byte after the input, like the terminator of strlen.
+ * Returns -1 once the call doesn't fit into span anymore. */
+static size_t
+replay_place(size_t *cur, size_t n, size_t align, size_t span)
+{
+	if (align >= REPLAY_ALIGN)
+		align = bench_urand() % REPLAY_ALIGN;
+	size_t off = ((*cur + REPLAY_ALIGN-1) & -REPLAY_ALIGN) + align;
+	if (off + n + 1 > span)
+		return -1;
+	*cur = off + n + 1;
+	return off;
+}
+
+/* hashes the outputs of all calls, which don't overlap */
+static ux
+replay_hash(ux seed, size_t nCalls)
+{
+	for (ReplayCall const *c = replayCalls; c != replayCalls + nCalls; ++c)
+		seed = bench_hash(seed, mem + c->dOff, c->n);
+	return seed;
+}
+
+static ux
+bench_replay_func(void *func, size_t nCalls)
+{
+	return replayBench->replay(func, replayCalls, nCalls);
+}
+
+/* Replays the same random sequence of calls, drawn from a size and
+ * alignment distribution, through every impl. Unlike the size sweeps, this
+ * exercises the branch predictors and vsetvl patterns of a realistic mix. */
+static void
+bench_replay(Bench *benches, size_t nBenches)
+{
+	size_t span = REPLAY_SPAN < MAX_MEM/2 ? REPLAY_SPAN : MAX_MEM/2;
+#if REPLAY == 1
+	replayMin = 0;
+#else
+	replay_load();
+	if (!replayEntries) {
+		print("ERROR: no replay entries read from stdin")(flush,);
+		exit(EXIT_FAILURE);
+	}
+#endif
+	for (Bench *b = benches; b != benches + nBenches; ++b) {
+		if (!b->replay)
+			continue;
+		size_t limit = span - REPLAY_ALIGN - 1;
+		if (b->N < limit)
+			limit = b->N;
+		if (replayMin >= limit) {
+			print("ERROR: no replay sizes below ")(u,limit);
+			print(" in ")(s,b->name)(flush,);
+			exit(EXIT_FAILURE);
+		}
+
+		/* stop early, once the span is full */
+		size_t dCur = 0, sCur = 0, bytes = 0, nCalls = 0;
+		for (ReplayCall *c = replayCalls; c != replayCalls + REPLAY_CALLS; ++c) {
+			do replay_sample(c); while (c->n >= limit);
+			c->dOff = replay_place(&dCur, c->n, c->dOff, span);
+			c->sOff = replay_place(&sCur, c->n, c->sOff, span);
+			if (c->dOff == (size_t)-1 || c->sOff == (size_t)-1)
+				break;
+			bytes += c->n, ++nCalls;
+		}
+
+		print("{\ntitle: \"")(s,b->name)(" replay\",\n");
+		print("labels: [");
+		for (size_t i = 0; i < b->nImpls; ++i)
+			print("\"")(s,b->impls[i].name)("\",");
+		print("],\ncalls: ")(u,nCalls)(",\nbytes: ")(u,bytes)(",\n");
+
+		Bench rb = *b;
+		rb.func = bench_replay_func;
+		replayBench = b;
+		print("cycles_per_call: [")(flush,);
+		ux s0 = 0;
+		for (size_t i = 0; i < b->nImpls; ++i) {
+			/* bpc is calls per cycle here */
+			benchRes[i][0] = bench_time(nCalls, b->impls[i], rb);
+			print(f,1 / benchRes[i][0].bpc)(",")(flush,);
+#if VALIDATE
+			/* the replay is deterministic, so the result of the last
+			 * repetition is compared */
+			ux si = replay_hash(replayResult, nCalls);
+			if (i == 0)
+				s0 = si;
+			else if (!b->impls[i].skipCheck && si != s0) {
+				print("\nERROR: ")(s,b->impls[i].name);
+				print(" in ")(s,b->name)(" replay")(flush,);
+				exit(EXIT_FAILURE);
+			}
+#endif
+		}
+		(void)s0;
+		print("],\ncycles_per_byte: [");
+		for (size_t i = 0; i < b->nImpls; ++i)
+			print(f,bytes ? nCalls / benchRes[i][0].bpc / bytes : 0)(",");
+		print("],\nmhz: [");
+		for (size_t i = 0; i < b->nImpls; ++i)
+			print(fn,1,benchRes[i][0].mhz)(",");
+		print("]\n},\n")(flush,);
+	}
+}
+# define BENCH_RUN bench_replay
+#else
+# define BENCH_RUN bench_run
+#endif
 
 #define BENCH_MAIN(benches) \
 	void bench_main(void) { \
-		bench_run(benches, ARR_LEN(benches)); \
+		BENCH_RUN(benches, ARR_LEN(benches)); \
 	}
 
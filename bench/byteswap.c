@@ -82,10 +82,7 @@ uint32_t *ptr;
 void init(void) { ptr = (uint32_t*)mem; }
 
 ux checksum(size_t n) {
-	ux sum = 0;
-	for (size_t i = 0; i < n; ++i)
-		sum = uhash(sum) + ptr[i];
-	return sum;
+	return bench_hash(0, ptr, n * sizeof *ptr);
 }
 
 BENCH_BEG(base) {
@@ -36,10 +36,7 @@ void init(void) {
 }
 
 ux checksum(size_t n) {
-	ux sum = 0;
-	for (size_t i = 0; i < n+16; ++i)
-		sum = uhash(sum) + mem[i];
-	return sum;
+	return bench_hash(0, mem, n+16);
 }
 
 BENCH_BEG(aligned) {
@@ -0,0 +1,299 @@
+#include "bench.h"
+#if __riscv_xlen != 32
+#include "../thirdparty/rvv-chacha-poly/boring.h"
+
+/* a TLS 1.2 record header as AAD, QUIC uses the packet header */
+#define AAD_LEN 13
+/* max lanes of the fused kernel, it needs r^0 to r^(4*POLY_LANES-3) */
+#define POLY_LANES 64
+#define POLY_MASK 0x3ffffff
+
+/* Poly1305 state with 26-bit limbs, pow[k] holds r^k in the first five
+ * words, and 5*r^k of the upper four limbs after them. The offsets are
+ * mirrored in chacha20poly1305.S. */
+typedef struct {
+	uint32_t key[8], nonce[3], ctr;
+	uint32_t h[5], s[4];
+	uint32_t pow[4*POLY_LANES-2][9];
+} Aead;
+
+extern void vector_chacha20(
+		uint8_t *out, const uint8_t *in,
+		size_t in_len, const uint8_t key[32],
+		const uint8_t nonce[12], uint32_t counter);
+
+extern uint64_t
+vector_poly1305(const uint8_t* in, size_t len,
+                const uint8_t key[32], uint8_t sig[16]);
+
+extern size_t vlmax_u32(void);
+
+/* Encrypts or decrypts nblocks 64 byte blocks starting at counter a->ctr,
+ * and hashes the ciphertext into a->h, in a single pass. */
+typedef void Blocks(uint8_t *dst, uint8_t const *src, size_t nblocks, Aead *a);
+extern Blocks chacha20poly1305_enc_rvv, chacha20poly1305_dec_rvv;
+
+static uint8_t key[32], nonce[12], aad[AAD_LEN], tag[16];
+
+static uint32_t
+load_le32(uint8_t const *p)
+{
+	return (uint32_t)p[3] << 24 | p[2] << 16 | p[1] << 8 | p[0];
+}
+
+static void
+store_le32(uint8_t *p, uint32_t x)
+{
+	p[0] = x; p[1] = x >> 8; p[2] = x >> 16; p[3] = x >> 24;
+}
+
+/* h = h * r, with the limbs only partially carried */
+static void
+poly_mul(uint32_t h[5], uint32_t const r[9])
+{
+	uint64_t d0 = (uint64_t)h[0]*r[0] + (uint64_t)h[4]*r[5] + (uint64_t)h[3]*r[6] + (uint64_t)h[2]*r[7] + (uint64_t)h[1]*r[8];
+	uint64_t d1 = (uint64_t)h[1]*r[0] + (uint64_t)h[0]*r[1] + (uint64_t)h[4]*r[6] + (uint64_t)h[3]*r[7] + (uint64_t)h[2]*r[8];
+	uint64_t d2 = (uint64_t)h[2]*r[0] + (uint64_t)h[1]*r[1] + (uint64_t)h[0]*r[2] + (uint64_t)h[4]*r[7] + (uint64_t)h[3]*r[8];
+	uint64_t d3 = (uint64_t)h[3]*r[0] + (uint64_t)h[2]*r[1] + (uint64_t)h[1]*r[2] + (uint64_t)h[0]*r[3] + (uint64_t)h[4]*r[8];
+	uint64_t d4 = (uint64_t)h[4]*r[0] + (uint64_t)h[3]*r[1] + (uint64_t)h[2]*r[2] + (uint64_t)h[1]*r[3] + (uint64_t)h[0]*r[4];
+	d1 += d0 >> 26; h[0] = d0 & POLY_MASK;
+	d2 += d1 >> 26; h[1] = d1 & POLY_MASK;
+	d3 += d2 >> 26; h[2] = d2 & POLY_MASK;
+	d4 += d3 >> 26; h[3] = d3 & POLY_MASK;
+	h[0] += (d4 >> 26) * 5; h[4] = d4 & POLY_MASK;
+	h[1] += h[0] >> 26; h[0] &= POLY_MASK;
+}
+
+static void
+poly_entry(uint32_t e[9], uint32_t const h[5])
+{
+	for (size_t i = 0; i < 5; ++i)
+		e[i] = h[i];
+	for (size_t i = 1; i < 5; ++i)
+		e[4+i] = h[i] * 5;
+}
+
+/* hashes n bytes, the last block is zero padded, as the AEAD does */
+static void
+poly_update(Aead *a, uint8_t const *p, size_t n)
+{
+	uint32_t *h = a->h;
+	while (n) {
+		uint8_t b[16] = { 0 };
+		size_t k = n < 16 ? n : 16;
+		memcpy(b, p, k);
+		uint32_t w0 = load_le32(b), w1 = load_le32(b+4);
+		uint32_t w2 = load_le32(b+8), w3 = load_le32(b+12);
+		h[0] += w0 & POLY_MASK;
+		h[1] += (w0 >> 26 | w1 << 6) & POLY_MASK;
+		h[2] += (w1 >> 20 | w2 << 12) & POLY_MASK;
+		h[3] += (w2 >> 14 | w3 << 18) & POLY_MASK;
+		h[4] += w3 >> 8 | 1 << 24;
+		poly_mul(h, a->pow[1]);
+		p += k, n -= k;
+	}
+}
+
+static void
+poly_finish(Aead *a, uint8_t mac[16])
+{
+	uint32_t h[5], g[5], c = 0;
+	for (size_t i = 0; i < 5; ++i)
+		h[i] = a->h[i] + c, c = h[i] >> 26, h[i] &= POLY_MASK;
+	h[0] += c * 5;
+	h[1] += h[0] >> 26, h[0] &= POLY_MASK;
+	/* h - p = h + 5 - 2^130, which is kept if it doesn't borrow */
+	c = 5;
+	for (size_t i = 0; i < 5; ++i)
+		g[i] = h[i] + c, c = g[i] >> 26, g[i] &= POLY_MASK;
+	uint32_t keep = -c;
+	for (size_t i = 0; i < 5; ++i)
+		h[i] = (h[i] & ~keep) | (g[i] & keep);
+	uint64_t f;
+	f = (uint64_t)(h[0] | h[1] << 26) + a->s[0];
+	store_le32(mac, f);
+	f = (uint64_t)(h[1] >> 6 | h[2] << 20) + a->s[1] + (f >> 32);
+	store_le32(mac+4, f);
+	f = (uint64_t)(h[2] >> 12 | h[3] << 14) + a->s[2] + (f >> 32);
+	store_le32(mac+8, f);
+	f = (uint64_t)(h[3] >> 18 | h[4] << 8) + a->s[3] + (f >> 32);
+	store_le32(mac+12, f);
+}
+
+/* sets up the key stream after the poly key block, and r^0 to r^(4k-3)
+ * for up to k lanes */
+static void
+aead_init(Aead *a, uint8_t const pk[32], size_t k)
+{
+	uint32_t r[5], t0 = load_le32(pk), t1 = load_le32(pk+4);
+	uint32_t t2 = load_le32(pk+8), t3 = load_le32(pk+12);
+	r[0] = t0 & 0x3ffffff;
+	r[1] = (t0 >> 26 | t1 << 6) & 0x3ffff03;
+	r[2] = (t1 >> 20 | t2 << 12) & 0x3ffc0ff;
+	r[3] = (t2 >> 14 | t3 << 18) & 0x3f03fff;
+	r[4] = t3 >> 8 & 0x00fffff;
+	memcpy(a->key, key, sizeof key);
+	memcpy(a->nonce, nonce, sizeof nonce);
+	a->ctr = 1;
+	for (size_t i = 0; i < 5; ++i)
+		a->h[i] = 0;
+	for (size_t i = 0; i < 4; ++i)
+		a->s[i] = load_le32(pk + 16 + 4*i);
+	uint32_t h[5] = { 1 };
+	poly_entry(a->pow[0], h);
+	for (size_t i = 1; i < 4*k-2; ++i) {
+		poly_mul(h, r);
+		poly_entry(a->pow[i], h);
+	}
+}
+
+/* the zero padding of the text, and the AAD and text lengths */
+static size_t
+aead_trailer(uint8_t *p, size_t n)
+{
+	memset(p, 0, -n & 15);
+	p += -n & 15;
+	store_le32(p, AAD_LEN); store_le32(p+4, 0);
+	store_le32(p+8, n); store_le32(p+12, (uint64_t)n >> 32);
+	return (-n & 15) + 16;
+}
+
+/* stores the tag when sealing, and compares it when opening */
+static int
+aead_tag(uint8_t tag[16], uint8_t const mac[16], int enc)
+{
+	uint8_t d = 0;
+	for (size_t i = 0; i < 16; ++i) {
+		d |= tag[i] ^ mac[i];
+		if (enc) tag[i] = mac[i];
+	}
+	return enc || !d;
+}
+
+/* Seals or opens the record at p in place: the AAD in the first 16 bytes,
+ * zero padded, and the n bytes of text after it. Opening returns whether
+ * the tag matched, and only decrypts if it did. The rvv impl also writes
+ * the padding and the lengths after the text, because vector_poly1305 can
+ * only hash a single buffer, which must be a multiple of 16 bytes. */
+typedef int Func(uint8_t *p, size_t n, uint8_t tag[16], int enc);
+
+/* two passes over the text, one with each of the thirdparty kernels */
+static int
+aead_boring(uint8_t *p, size_t n, uint8_t tag[16], int enc)
+{
+	uint8_t pk[32] = { 0 }, mac[16], trailer[32];
+	poly1305_state st;
+	boring_chacha20(pk, pk, sizeof pk, key, nonce, 0);
+	if (enc)
+		boring_chacha20(p+16, p+16, n, key, nonce, 1);
+	boring_poly1305_init(&st, pk);
+	boring_poly1305_update(&st, p, 16+n);
+	boring_poly1305_update(&st, trailer, aead_trailer(trailer, n));
+	boring_poly1305_finish(&st, mac);
+	int ok = aead_tag(tag, mac, enc);
+	if (!enc && ok)
+		boring_chacha20(p+16, p+16, n, key, nonce, 1);
+	return ok;
+}
+
+static int
+aead_rvv(uint8_t *p, size_t n, uint8_t tag[16], int enc)
+{
+	uint8_t pk[32] = { 0 }, mac[16];
+	vector_chacha20(pk, pk, sizeof pk, key, nonce, 0);
+	if (enc)
+		vector_chacha20(p+16, p+16, n, key, nonce, 1);
+	size_t len = 16 + n + aead_trailer(p+16+n, n);
+	vector_poly1305(p, len, pk, mac);
+	int ok = aead_tag(tag, mac, enc);
+	if (!enc && ok)
+		vector_chacha20(p+16, p+16, n, key, nonce, 1);
+	return ok;
+}
+
+/* Every ciphertext block is hashed right after it was encrypted, or right
+ * before it is decrypted, while it's still in registers. Opening has to
+ * decrypt before it knows whether the tag matches, so it clears the text
+ * on a mismatch. */
+static int
+aead_rvv_fused(uint8_t *p, size_t n, uint8_t tag[16], int enc)
+{
+	static Aead a;
+	uint8_t pk[32] = { 0 }, mac[16], trailer[32];
+	size_t nb = n / 64, r = n % 64, k = vlmax_u32();
+	uint8_t *tail = p + 16 + nb*64;
+	k = k < POLY_LANES ? k : POLY_LANES;
+	k = k < nb ? k : nb;
+	vector_chacha20(pk, pk, sizeof pk, key, nonce, 0);
+	aead_init(&a, pk, k ? k : 1);
+	poly_update(&a, p, 16);
+	(enc ? chacha20poly1305_enc_rvv : chacha20poly1305_dec_rvv)(p+16, p+16, nb, &a);
+	if (!enc)
+		poly_update(&a, tail, r);
+	vector_chacha20(tail, tail, r, key, nonce, a.ctr);
+	if (enc)
+		poly_update(&a, tail, r);
+	/* poly_update already padded the text */
+	aead_trailer(trailer, n);
+	poly_update(&a, trailer + (-n & 15), 16);
+	poly_finish(&a, mac);
+	int ok = aead_tag(tag, mac, enc);
+	if (!ok)
+		memset(p+16, 0, n);
+	return ok;
+}
+
+Impl impls[] = {
+	{ "boring", &aead_boring, 0 },
+	IF_VE64({ "rvv", &aead_rvv, 0 },)
+	IF_VE64({ "rvv fused", &aead_rvv_fused, 0 },)
+};
+
+static uint8_t *rec, *text;
+static int ok;
+
+void init(void) {
+	bench_memrand(key, sizeof key);
+	bench_memrand(nonce, sizeof nonce);
+	bench_memrand(aad, sizeof aad);
+	rec = mem;
+	text = mem + MAX_MEM/2;
+}
+
+ux checksum(size_t n) {
+	return bench_hash(bench_hash(ok, tag, sizeof tag), rec, n+16);
+}
+
+static void
+record(size_t n)
+{
+	memcpy(rec, aad, AAD_LEN);
+	memset(rec + AAD_LEN, 0, 16 - AAD_LEN);
+	memcpy(rec + 16, text, n);
+}
+
+BENCH_BEG(seal) {
+	record(n);
+	TIME ok = f(rec, n, tag, 1);
+} BENCH_END
+
+/* the record is sealed by the boring impl, the tag check is timed */
+BENCH_BEG(open) {
+	record(n);
+	aead_boring(rec, n, tag, 1);
+	TIME ok = f(rec, n, tag, 0);
+} BENCH_END
+
+Bench benches[] = {
+	BENCH( impls, 1024*256, "chacha20-poly1305 seal", bench_seal ),
+	BENCH( impls, 1024*256, "chacha20-poly1305 open", bench_open ),
+}; BENCH_MAIN(benches)
+
+
+#include "../thirdparty/rvv-chacha-poly/boring.c"
+#else
+void init(void) {}
+Impl impls[] = {};
+Bench benches[] = {};
+BENCH_MAIN(benches)
+#endif
@@ -11,8 +11,46 @@
 /* stop repeats early afer this many cycles have elapsed */
 #define STOP_CYCLES (1024*1024*500)
 
+/* frequency of the time CSR in Hz, used to report bytes/ns and the effective
+ * clock frequency, 0 reads it from the devicetree when hosted */
+#define TIMEBASE_FREQ 0
+
+/* drop samples whose cycles/time ratio deviates by more than this factor
+ * from the median, only samples of at least DRIFT_MIN_TICKS are checked */
+#define DRIFT_MAX 0.05
+#define DRIFT_MIN_TICKS 64
+
+/* interleave the impls in a random order for every repetition, instead of
+ * measuring one impl after another, this removes bias from slow drift */
+#define INTERLEAVE 0
+
 /* validate against reference implementation on the first repetition */
 #define VALIDATE 1
+/* only validate every n-th size, to speed up slow targets and emulators */
+#define VALIDATE_EVERY 1
+
+/* instead of benchmarking, run the impls on inputs placed flush against
+ * PROT_NONE guard pages and report faults, only in hosted environments */
+#define GUARD_CHECK 0
+/* number of random sizes per impl, and the maximum size */
+#define GUARD_RUNS 2000
+#define GUARD_MEM (1024*64)
+
+/* instead of sweeping sizes, replay a random sequence of REPLAY_CALLS calls,
+ * with sizes and alignments drawn from: 0 off, 1 a builtin heavy-tailed
+ * distribution, 2 a histogram or raw trace read from stdin, with lines of
+ * "size [count [dest_align [src_align]]]" */
+#define REPLAY 0
+#define REPLAY_CALLS 4096
+/* the calls are laid out consecutively within this many bytes, and the
+ * sequence ends early once they don't fit, the builtin distribution
+ * averages about 700 bytes per call */
+#define REPLAY_SPAN (1024*1024*4)
+
+/* calls per timed region in the latency and throughput benchmarks, which
+ * chain dependent calls, or issue independent ones, to hide the timer
+ * overhead for short inputs */
+#define CHAIN_CALLS 16
 
 /* custom scaling factors for benchmarks, these are used to make sure each
  * benchmark approximately takes the same amount of time. */
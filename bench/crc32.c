@@ -0,0 +1,167 @@
+#include "bench.h"
+
+/* bit reflected CRC32 with pre and post inversion, like zlib's crc32() */
+
+typedef struct {
+	uint64_t poly, qt, lanes;
+	/* fold[i] = { x^(128d+63), x^(128d-1) } mod P, for d = lanes - i */
+	uint64_t fold[64][2];
+	uint32_t table[8][256];
+} Crc;
+
+/* not inverted, the impls pass the remaining bytes here */
+uint32_t
+crc_tail(uint32_t crc, uint8_t const *p, size_t n, Crc const *c)
+{
+	while (n--)
+		crc = c->table[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+	return ~crc;
+}
+
+uint32_t
+crc32_scalar(uint32_t crc, uint8_t const *p, size_t n, Crc const *c)
+{
+	crc = ~crc;
+	while (n--)
+		crc = c->table[0][(crc ^ *p++) & 0xff] ^ (crc >> 8), BENCH_CLOBBER();
+	return ~crc;
+}
+
+uint32_t
+crc32_slice8(uint32_t crc, uint8_t const *p, size_t n, Crc const *c)
+{
+	crc = ~crc;
+	for (; n >= 8; n -= 8, p += 8) {
+		uint32_t x = crc ^ (p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24);
+		crc = c->table[7][x & 0xff] ^ c->table[6][x >> 8 & 0xff] ^
+		      c->table[5][x >> 16 & 0xff] ^ c->table[4][x >> 24] ^
+		      c->table[3][p[4]] ^ c->table[2][p[5]] ^
+		      c->table[1][p[6]] ^ c->table[0][p[7]];
+	}
+	return crc_tail(crc, p, n, c);
+}
+
+#if __riscv_xlen == 64 && __riscv_zbc
+# define IMPLS_ZBC(f) f(zbc)
+#else
+# define IMPLS_ZBC(f)
+#endif
+
+#if __riscv_xlen == 64 && __riscv_v_elen >= 64 && __riscv_zvbc
+# define IMPLS_ZVBC(f) f(rvv_m1) f(rvv_m2) f(rvv_m4)
+#else
+# define IMPLS_ZVBC(f)
+#endif
+
+#define IMPLS(f) \
+	f(scalar) \
+	f(slice8) \
+	IMPLS_ZBC(f) \
+	IMPLS_ZVBC(f) \
+
+typedef uint32_t Func(uint32_t crc, uint8_t const *p, size_t n, Crc const *c);
+
+#define DECLARE(f) extern Func crc32_##f;
+IMPLS(DECLARE)
+
+#define EXTRACT(f) { #f, &crc32_##f, 0 },
+Impl impls[] = { IMPLS(EXTRACT) };
+
+/* x^k mod P, bit reflected */
+static uint32_t
+crc_xpow(uint32_t poly, size_t k)
+{
+	uint32_t x = 1u << 31;
+	while (k--)
+		x = (x >> 1) ^ (x & 1 ? poly : 0);
+	return x;
+}
+
+static void
+crc_init(Crc *c, uint32_t poly)
+{
+	c->poly = poly;
+	c->lanes = ARR_LEN(c->fold);
+	for (size_t i = 0; i < 256; ++i) {
+		uint32_t x = i;
+		for (size_t j = 0; j < 8; ++j)
+			x = (x >> 1) ^ (x & 1 ? poly : 0);
+		c->table[0][i] = x;
+	}
+	for (size_t k = 1; k < 8; ++k)
+		for (size_t i = 0; i < 256; ++i) {
+			uint32_t x = c->table[k-1][i];
+			c->table[k][i] = c->table[0][x & 0xff] ^ (x >> 8);
+		}
+
+	/* the 128-bit lanes are folded with clmul and clmulh, which loses one
+	 * bit, hence the exponents are one less than the fold distance */
+	for (size_t i = 0; i < c->lanes; ++i) {
+		size_t d = c->lanes - i;
+		c->fold[i][0] = (uint64_t)crc_xpow(poly, 128*d + 63) << 32;
+		c->fold[i][1] = (uint64_t)crc_xpow(poly, 128*d - 1) << 32;
+	}
+
+	/* Barrett quotient x^96 / P, bit reflected and without the x^64 term,
+	 * see https://www.corsix.org/content/barrett-reduction-polynomials */
+	uint64_t p = 1ull << 32, r = 0;
+	for (size_t i = 0; i < 32; ++i)
+		p |= (uint64_t)(poly >> i & 1) << (31 - i);
+	c->qt = 0;
+	for (int i = 96; i >= 0; --i) {
+		r = r << 1 | (i == 96);
+		if (r >> 32 & 1) {
+			r ^= p;
+			if (i < 64)
+				c->qt |= 1ull << (63 - i);
+		}
+	}
+}
+
+static Crc crc32, crc32c;
+uint32_t last;
+
+void init(void) {
+	crc_init(&crc32, 0xedb88320);
+	crc_init(&crc32c, 0x82f63b78);
+}
+
+ux checksum(size_t n) { return last; }
+
+BENCH_BEG(crc32) {
+	TIME last = f(0, mem, n, &crc32);
+} BENCH_END
+
+BENCH_BEG(crc32c) {
+	TIME last = f(0, mem, n, &crc32c);
+} BENCH_END
+
+/* independent blocks, each starting on a cache line */
+BENCH_BEG(small32) {
+	size_t stride = (n + 63) & -64;
+	last = 0;
+	TIME for (size_t k = 0; k < CHAIN_CALLS; ++k)
+		last ^= f(k, mem + k*stride, n, &crc32);
+} BENCH_END
+
+BENCH_BEG(small32c) {
+	size_t stride = (n + 63) & -64;
+	last = 0;
+	TIME for (size_t k = 0; k < CHAIN_CALLS; ++k)
+		last ^= f(k, mem + k*stride, n, &crc32c);
+} BENCH_END
+
+GUARD_BEG(crc32) {
+	return f(n, p, n, &crc32);
+} GUARD_END
+
+GUARD_BEG(crc32c) {
+	return f(n, p, n, &crc32c);
+} GUARD_END
+
+Bench benches[] = {
+	BENCH( impls, MAX_MEM, "crc32", bench_crc32, guard_crc32 ),
+	BENCH( impls, MAX_MEM, "crc32c", bench_crc32c, guard_crc32c ),
+	BENCH( impls, 1024, "crc32 small blocks", bench_small32, .calls = CHAIN_CALLS ),
+	BENCH( impls, 1024, "crc32c small blocks", bench_small32c, .calls = CHAIN_CALLS ),
+}; BENCH_MAIN(benches)
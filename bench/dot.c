@@ -0,0 +1,116 @@
+#include "bench.h"
+
+/* The sums wrap around like int32_t arithmetic. */
+
+int32_t
+dot_i8_scalar(void const *a, void const *b, size_t n)
+{
+	int8_t const *x = a, *y = b;
+	uint32_t sum = 0;
+	for (size_t i = 0; i < n; ++i)
+		sum += x[i] * y[i], BENCH_CLOBBER();
+	return sum;
+}
+
+int32_t
+dot_i8_scalar_autovec(void const *a, void const *b, size_t n)
+{
+	int8_t const *x = a, *y = b;
+	uint32_t sum = 0;
+	for (size_t i = 0; i < n; ++i)
+		sum += x[i] * y[i];
+	return sum;
+}
+
+int32_t
+dot_u8i8_scalar(void const *a, void const *b, size_t n)
+{
+	uint8_t const *x = a;
+	int8_t const *y = b;
+	uint32_t sum = 0;
+	for (size_t i = 0; i < n; ++i)
+		sum += x[i] * y[i], BENCH_CLOBBER();
+	return sum;
+}
+
+int32_t
+dot_u8i8_scalar_autovec(void const *a, void const *b, size_t n)
+{
+	uint8_t const *x = a;
+	int8_t const *y = b;
+	uint32_t sum = 0;
+	for (size_t i = 0; i < n; ++i)
+		sum += x[i] * y[i];
+	return sum;
+}
+
+int32_t
+dot_i16_scalar(void const *a, void const *b, size_t n)
+{
+	int16_t const *x = a, *y = b;
+	uint32_t sum = 0;
+	for (size_t i = 0; i < n; ++i)
+		sum += x[i] * y[i], BENCH_CLOBBER();
+	return sum;
+}
+
+int32_t
+dot_i16_scalar_autovec(void const *a, void const *b, size_t n)
+{
+	int16_t const *x = a, *y = b;
+	uint32_t sum = 0;
+	for (size_t i = 0; i < n; ++i)
+		sum += x[i] * y[i];
+	return sum;
+}
+
+/* the 8-bit products need LMUL*4 for the accumulators, the 16-bit LMUL*2 */
+#define IMPLS8(f,T) \
+	f(T##_scalar) \
+	f(T##_scalar_autovec) \
+	f(T##_rvv_m1) \
+	f(T##_rvv_m2) \
+
+#define IMPLS16(f,T) \
+	IMPLS8(f,T) \
+	f(T##_rvv_m4) \
+
+/* the dot product of the n elements of a and b */
+typedef int32_t Func(void const *a, void const *b, size_t n);
+
+#define DECLARE(f) extern Func dot_##f;
+IMPLS8(DECLARE, i8)
+IMPLS8(DECLARE, u8i8)
+IMPLS16(DECLARE, i16)
+
+#define EXTRACT(f) { #f, &dot_##f, 0 },
+Impl implsI8[] = { IMPLS8(EXTRACT, i8) };
+Impl implsU8I8[] = { IMPLS8(EXTRACT, u8i8) };
+Impl implsI16[] = { IMPLS16(EXTRACT, i16) };
+
+static uint8_t *a, *b;
+static ux last;
+
+void init(void) {
+	a = mem;
+	b = mem + MAX_MEM/2;
+}
+
+ux checksum(size_t n) {
+	return last;
+}
+
+BENCH_BEG(8) {
+	TIME last = (uint32_t)f(a, b, n);
+} BENCH_END
+
+BENCH_BEG(16) {
+	n /= sizeof(int16_t);
+	TIME last = (uint32_t)f(a, b, n);
+} BENCH_END
+
+Bench benches[] = {
+	BENCH( implsI8, MAX_MEM/2, "dot i8", bench_8 ),
+	BENCH( implsU8I8, MAX_MEM/2, "dot u8 i8", bench_8 ),
+	BENCH( implsI16, MAX_MEM/2, "dot i16", bench_16 ),
+}; BENCH_MAIN(benches)
@@ -0,0 +1,69 @@
+#include "bench.h"
+
+size_t
+filter_scalar(uint32_t *dst, uint32_t const *src, size_t n, uint32_t lim)
+{
+	uint32_t *d = dst;
+	for (size_t i = 0; i < n; ++i) {
+		if (src[i] < lim)
+			*d++ = src[i];
+		BENCH_CLOBBER();
+	}
+	return d - dst;
+}
+
+size_t
+filter_scalar_branchless(uint32_t *dst, uint32_t const *src, size_t n, uint32_t lim)
+{
+	uint32_t *d = dst;
+	for (size_t i = 0; i < n; ++i) {
+		*d = src[i];
+		d += src[i] < lim;
+		BENCH_CLOBBER();
+	}
+	return d - dst;
+}
+
+#define IMPLS(f) \
+	f(scalar) \
+	f(scalar_branchless) \
+	MX(f, rvv_vcompress) \
+	MX(f, rvv_viota) \
+
+/* copies the elements of src below lim to dst, returns their number */
+typedef size_t Func(uint32_t *dst, uint32_t const *src, size_t n, uint32_t lim);
+
+#define DECLARE(f) extern Func filter_##f;
+IMPLS(DECLARE)
+
+#define EXTRACT(f) { #f, &filter_##f, 0 },
+Impl impls[] = { IMPLS(EXTRACT) };
+
+static uint32_t *dst, *src;
+static size_t last;
+
+void init(void) {
+	dst = (uint32_t*)mem;
+	src = (uint32_t*)(mem + MAX_MEM/2);
+}
+
+ux checksum(size_t n) {
+	return bench_hash(last, dst, last * sizeof *dst);
+}
+
+/* keeps about sel percent of the random elements */
+#define BENCH_SEL(sel) \
+	BENCH_BEG(sel) { \
+		n /= sizeof *src; \
+		TIME last = f(dst, src, n, (uint64_t)sel * 0xffffffff / 100); \
+	} BENCH_END
+
+BENCH_SEL(5)
+BENCH_SEL(50)
+BENCH_SEL(95)
+
+Bench benches[] = {
+	BENCH( impls, MAX_MEM/2, "filter 5% selected", bench_5 ),
+	BENCH( impls, MAX_MEM/2, "filter 50% selected", bench_50 ),
+	BENCH( impls, MAX_MEM/2, "filter 95% selected", bench_95 ),
+}; BENCH_MAIN(benches)
@@ -0,0 +1,188 @@
+#include "bench.h"
+
+/* The conversions convert the n elements at a to dst and ignore b. The dot
+ * products store the f32 sum of the n products of a and b to dst. */
+typedef void Func(void *dst, void const *a, void const *b, size_t n);
+
+static inline uint32_t f32_bits(float f) { uint32_t u; memcpy(&u, &f, 4); return u; }
+static inline float f32_from(uint32_t u) { float f; memcpy(&f, &u, 4); return f; }
+
+/* round to nearest even, overflows to infinity, quiets NaNs */
+static inline uint16_t
+f32_to_f16(float f)
+{
+	uint32_t x = f32_bits(f), sign = x & 0x80000000, o;
+	x ^= sign;
+	if (x >= 0x47800000) {
+		/* 2^16 and up */
+		o = x > 0x7f800000 ? 0x7e00 : 0x7c00;
+	} else if (x < 0x38800000) {
+		/* below 2^-14, the addition rounds the mantissa into place */
+		o = f32_bits(f32_from(x) + 0.5f) - 0x3f000000;
+	} else {
+		x += ((uint32_t)(15 - 127) << 23) + 0xfff + (x >> 13 & 1);
+		o = x >> 13;
+	}
+	return o | sign >> 16;
+}
+
+static inline float
+f16_to_f32(uint16_t h)
+{
+	uint32_t o = (uint32_t)(h & 0x7fff) << 13, exp = o & 0x0f800000;
+	o += (uint32_t)(127 - 15) << 23;
+	if (exp == 0x0f800000)
+		o += (uint32_t)(128 - 16) << 23;
+	else if (exp == 0)
+		o = f32_bits(f32_from(o + (1 << 23)) - f32_from(113 << 23));
+	return f32_from(o | (uint32_t)(h & 0x8000) << 16);
+}
+
+/* round to nearest even, NaNs become the canonical NaN */
+static inline uint16_t
+f32_to_bf16(float f)
+{
+	uint32_t x = f32_bits(f);
+	if ((x & 0x7fffffff) > 0x7f800000)
+		return 0x7fc0;
+	return (x + 0x7fff + (x >> 16 & 1)) >> 16;
+}
+
+static inline float
+bf16_to_f32(uint16_t h)
+{
+	return f32_from((uint32_t)h << 16);
+}
+
+#define CONVERT_SCALAR(name, D, S, conv) \
+	void name##_scalar(void *dst, void const *a, void const *b, size_t n) { \
+		D *d = dst; S const *s = a; \
+		for (size_t i = 0; i < n; ++i) \
+			d[i] = conv(s[i]), BENCH_CLOBBER(); \
+	} \
+	void name##_scalar_autovec(void *dst, void const *a, void const *b, size_t n) { \
+		D *d = dst; S const *s = a; \
+		for (size_t i = 0; i < n; ++i) \
+			d[i] = conv(s[i]); \
+	}
+CONVERT_SCALAR(f32_to_f16, uint16_t, float, f32_to_f16)
+CONVERT_SCALAR(f16_to_f32, float, uint16_t, f16_to_f32)
+CONVERT_SCALAR(f32_to_bf16, uint16_t, float, f32_to_bf16)
+CONVERT_SCALAR(bf16_to_f32, float, uint16_t, bf16_to_f32)
+
+void
+bf16_dot_scalar(void *dst, void const *a, void const *b, size_t n)
+{
+	uint16_t const *x = a, *y = b;
+	float sum = 0;
+	for (size_t i = 0; i < n; ++i)
+		sum += bf16_to_f32(x[i]) * bf16_to_f32(y[i]), BENCH_CLOBBER();
+	*(float*)dst = sum;
+}
+
+void
+bf16_dot_scalar_autovec(void *dst, void const *a, void const *b, size_t n)
+{
+	uint16_t const *x = a, *y = b;
+	float sum = 0;
+	for (size_t i = 0; i < n; ++i)
+		sum += bf16_to_f32(x[i]) * bf16_to_f32(y[i]);
+	*(float*)dst = sum;
+}
+
+/* The _rvv_int impls do the bf16 conversions with integer instructions,
+ * and only need the V extension. */
+#define IMPLS_F16(f,T) \
+	f(T##_scalar) \
+	f(T##_scalar_autovec) \
+	IF_VF16MIN(MX(f, T##_rvv)) \
+
+#define IMPLS_BF16(f,T) \
+	f(T##_scalar) \
+	f(T##_scalar_autovec) \
+	MX(f, T##_rvv_int) \
+	IF_VBF16MIN(MX(f, T##_rvv)) \
+
+#define IMPLS_DOT(f,T) \
+	f(T##_scalar) \
+	f(T##_scalar_autovec) \
+	MX(f, T##_rvv_int) \
+	IF_VBF16WMA(MX(f, T##_rvv)) \
+
+#define DECLARE(f) extern Func f;
+IMPLS_F16(DECLARE, f32_to_f16)
+IMPLS_F16(DECLARE, f16_to_f32)
+IMPLS_BF16(DECLARE, f32_to_bf16)
+IMPLS_BF16(DECLARE, bf16_to_f32)
+IMPLS_DOT(DECLARE, bf16_dot)
+
+#define EXTRACT(f) { #f, &f, 0 },
+Impl implsToF16[] = { IMPLS_F16(EXTRACT, f32_to_f16) };
+Impl implsFromF16[] = { IMPLS_F16(EXTRACT, f16_to_f32) };
+Impl implsToBF16[] = { IMPLS_BF16(EXTRACT, f32_to_bf16) };
+Impl implsFromBF16[] = { IMPLS_BF16(EXTRACT, bf16_to_f32) };
+Impl implsDot[] = { IMPLS_DOT(EXTRACT, bf16_dot) };
+
+static uint8_t *dst, *fsrc, *hsrc, *bfsrc, *dotsrc;
+static size_t last;
+
+void init(void) {
+	dst = mem;
+	fsrc = mem + MAX_MEM/4;
+	hsrc = mem + MAX_MEM/2;
+	bfsrc = mem + MAX_MEM*5/8;
+	dotsrc = mem + MAX_MEM*3/4;
+	/* Finite floats with exponents from 2^-30 to 2^17, so some become
+	 * f16 subnormals, zeros and infinities. */
+	uint32_t *f = (uint32_t*)fsrc;
+	size_t nf = MAX_MEM/4/sizeof(float);
+	for (size_t i = 0; i < nf; ++i)
+		f[i] = (bench_urand() & 0x807fffff) | (97 + bench_urand() % 48) << 23;
+	uint16_t *h = (uint16_t*)hsrc, *bf = (uint16_t*)bfsrc;
+	for (size_t i = 0; i < nf; ++i) {
+		h[i] = f32_to_f16(f32_from(f[i]));
+		bf[i] = f32_to_bf16(f32_from(f[i]));
+	}
+	/* Integers from -2 to 2, whose dot products sum exactly in f32, so
+	 * the order of the additions doesn't change the result. */
+	h = (uint16_t*)dotsrc;
+	for (size_t i = 0; i < MAX_MEM/4/sizeof(uint16_t); ++i)
+		h[i] = f32_to_bf16((int)(bench_urand() % 5) - 2);
+}
+
+ux checksum(size_t n) {
+	return bench_hash(0, dst, last);
+}
+
+BENCH_BEG(narrow) {
+	n /= sizeof(float);
+	last = n * sizeof(uint16_t);
+	TIME f(dst, fsrc, 0, n);
+} BENCH_END
+
+BENCH_BEG(widen_f16) {
+	n /= sizeof(float);
+	last = n * sizeof(float);
+	TIME f(dst, hsrc, 0, n);
+} BENCH_END
+
+BENCH_BEG(widen_bf16) {
+	n /= sizeof(float);
+	last = n * sizeof(float);
+	TIME f(dst, bfsrc, 0, n);
+} BENCH_END
+
+BENCH_BEG(dot) {
+	n /= 2 * sizeof(uint16_t);
+	last = sizeof(float);
+	TIME f(dst, dotsrc, dotsrc + n*sizeof(uint16_t), n);
+} BENCH_END
+
+/* sizes in bytes of f32, and of both bf16 inputs for the dot products */
+Bench benches[] = {
+	BENCH( implsToF16, MAX_MEM/4, "convert f32 to f16", bench_narrow ),
+	BENCH( implsFromF16, MAX_MEM/4, "convert f16 to f32", bench_widen_f16 ),
+	BENCH( implsToBF16, MAX_MEM/4, "convert f32 to bf16", bench_narrow ),
+	BENCH( implsFromBF16, MAX_MEM/4, "convert bf16 to f32", bench_widen_bf16 ),
+	BENCH( implsDot, MAX_MEM/4, "dot product bf16 to f32", bench_dot ),
+}; BENCH_MAIN(benches)
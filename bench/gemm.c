@@ -0,0 +1,165 @@
+#include "bench.h"
+
+/* c = a * b, with row-major a of m by k, b of k by n and c of m by n
+ * elements, which are int8_t for a and b and int32_t for c, or all float */
+typedef void Func(void *c, void const *a, void const *b, size_t m, size_t k, size_t n);
+
+void
+gemm_i8_scalar(void *c, void const *a, void const *b, size_t m, size_t k, size_t n)
+{
+	int32_t *C = c;
+	int8_t const *A = a, *B = b;
+	for (size_t i = 0; i < m; ++i)
+		for (size_t j = 0; j < n; ++j) {
+			int32_t sum = 0;
+			for (size_t l = 0; l < k; ++l)
+				sum += A[i*k + l] * B[l*n + j], BENCH_CLOBBER();
+			C[i*n + j] = sum;
+		}
+}
+
+void
+gemm_f32_scalar(void *c, void const *a, void const *b, size_t m, size_t k, size_t n)
+{
+	float *C = c;
+	float const *A = a, *B = b;
+	for (size_t i = 0; i < m; ++i)
+		for (size_t j = 0; j < n; ++j) {
+			float sum = 0;
+			for (size_t l = 0; l < k; ++l)
+				sum += A[i*k + l] * B[l*n + j], BENCH_CLOBBER();
+			C[i*n + j] = sum;
+		}
+}
+
+/* the loop order that vectorizes over the rows of b and c */
+void
+gemm_i8_scalar_autovec(void *c, void const *a, void const *b, size_t m, size_t k, size_t n)
+{
+	int32_t *C = c;
+	int8_t const *A = a, *B = b;
+	for (size_t i = 0; i < m; ++i) {
+		memset(C + i*n, 0, n * sizeof *C);
+		for (size_t l = 0; l < k; ++l)
+			for (size_t j = 0; j < n; ++j)
+				C[i*n + j] += A[i*k + l] * B[l*n + j];
+	}
+}
+
+void
+gemm_f32_scalar_autovec(void *c, void const *a, void const *b, size_t m, size_t k, size_t n)
+{
+	float *C = c;
+	float const *A = a, *B = b;
+	for (size_t i = 0; i < m; ++i) {
+		memset(C + i*n, 0, n * sizeof *C);
+		for (size_t l = 0; l < k; ++l)
+			for (size_t j = 0; j < n; ++j)
+				C[i*n + j] += A[i*k + l] * B[l*n + j];
+	}
+}
+
+/* computes four rows of c */
+typedef void RowPanel(void *c, void const *a, void const *b, size_t k, size_t n);
+/* computes four columns of c */
+typedef void ColPanel(void *c, void const *a, void const *b, size_t m, size_t k, size_t n);
+
+/* The last panel overlaps the previous one, when m or n isn't a multiple of
+ * four, which recomputes the same values. */
+
+static void
+gemm_rows(RowPanel *f, Func *small, size_t w, char *c, char const *a, void const *b, size_t m, size_t k, size_t n)
+{
+	if (m < 4) {
+		small(c, a, b, m, k, n);
+		return;
+	}
+	for (size_t i = 0; i < m; i += 4) {
+		size_t r = i + 4 > m ? m - 4 : i;
+		f(c + r*n*4, a + r*k*w, b, k, n);
+	}
+}
+
+static void
+gemm_cols(ColPanel *f, Func *small, size_t w, char *c, void const *a, char const *b, size_t m, size_t k, size_t n)
+{
+	if (n < 4) {
+		small(c, a, b, m, k, n);
+		return;
+	}
+	for (size_t j = 0; j < n; j += 4) {
+		size_t r = j + 4 > n ? n - 4 : j;
+		f(c + r*4, a, b + r*w, m, k, n);
+	}
+}
+
+#define GEMM_RVV(T, w, lmul) \
+	extern RowPanel gemm_##T##_rvv_vx_panel_##lmul; \
+	extern ColPanel gemm_##T##_rvv_strided_panel_##lmul; \
+	void gemm_##T##_rvv_vx_##lmul(void *c, void const *a, void const *b, size_t m, size_t k, size_t n) { \
+		gemm_rows(gemm_##T##_rvv_vx_panel_##lmul, gemm_##T##_scalar, w, c, a, b, m, k, n); \
+	} \
+	void gemm_##T##_rvv_strided_##lmul(void *c, void const *a, void const *b, size_t m, size_t k, size_t n) { \
+		gemm_cols(gemm_##T##_rvv_strided_panel_##lmul, gemm_##T##_scalar, w, c, a, b, m, k, n); \
+	}
+GEMM_RVV(i8, 1, m1)
+GEMM_RVV(i8, 1, m2)
+GEMM_RVV(i8, 1, m4)
+GEMM_RVV(f32, 4, m1)
+GEMM_RVV(f32, 4, m2)
+GEMM_RVV(f32, 4, m4)
+
+/* the LMUL of the four int32_t or float accumulators */
+#define IMPLS(f,T) \
+	f(T##_scalar) \
+	f(T##_scalar_autovec) \
+	f(T##_rvv_vx_m1) \
+	f(T##_rvv_vx_m2) \
+	f(T##_rvv_vx_m4) \
+	f(T##_rvv_strided_m1) \
+	f(T##_rvv_strided_m2) \
+	f(T##_rvv_strided_m4) \
+
+#define EXTRACT(f) { #f, &gemm_##f, 0 },
+Impl implsI8[] = { IMPLS(EXTRACT, i8) };
+Impl implsF32[] = { IMPLS(EXTRACT, f32) };
+
+#define MAX_DIM 128
+
+static uint8_t *c, *a, *b, *fa, *fb;
+static size_t last;
+
+void init(void) {
+	c = mem;
+	a = mem + MAX_MEM/4;
+	b = mem + MAX_MEM/4 + MAX_DIM*MAX_DIM;
+	fa = mem + MAX_MEM/2;
+	fb = mem + MAX_MEM/2 + MAX_DIM*MAX_DIM*sizeof(float);
+	/* Small integers, which multiply and sum exactly, so neither the
+	 * order of the additions nor fused multiply-adds change the result. */
+	float *f = (float*)fa;
+	for (size_t i = 0; i < 2*MAX_DIM*MAX_DIM; ++i)
+		f[i] = (int)(bench_urand() & 15) - 8;
+}
+
+ux checksum(size_t n) {
+	return bench_hash(0, c, last);
+}
+
+/* square matrices of usqrt(n) rows */
+BENCH_BEG(i8) {
+	n = usqrt(n);
+	last = n*n*sizeof(int32_t);
+	TIME f(c, a, b, n, n, n);
+} BENCH_END
+
+BENCH_BEG(f32) {
+	n = usqrt(n);
+	last = n*n*sizeof(float);
+	TIME f(c, fa, fb, n, n, n);
+} BENCH_END
+
+Bench benches[] = {
+	BENCH( implsI8, MAX_DIM*MAX_DIM, "gemm i8", bench_i8 ),
+	BENCH( implsF32, MAX_DIM*MAX_DIM, "sgemm f32", bench_f32 ),
+}; BENCH_MAIN(benches)
@@ -0,0 +1,240 @@
+#include "bench.h"
+
+/* GF(2^8) with the polynomial 0x11d, as used by ISA-L and Jerasure */
+#define GF_POLY 0x11d
+
+typedef struct {
+	uint8_t mul[256][256];
+	/* c*x = nib[c][x & 15] ^ nib[c][16 + (x >> 4)] */
+	uint8_t nib[256][32];
+	/* room for whole register loads of nib, up to VLEN=65536 */
+	uint8_t pad[8192];
+	/* log[0] = 511, so that exp[] of a sum involving it is 0 */
+	uint16_t log[256];
+	uint8_t exp[1024];
+} Gf;
+
+/* out[j][x] ^= sum of coef[j*nIn+i] * in[i][x], with nOut <= 4 */
+typedef void Func(uint8_t **out, uint8_t const *const *in, size_t nOut,
+                  size_t nIn, uint8_t const *coef, size_t len, Gf const *gf);
+
+void
+gf_mad_scalar(uint8_t **out, uint8_t const *const *in, size_t nOut,
+              size_t nIn, uint8_t const *coef, size_t len, Gf const *gf)
+{
+	for (size_t x = 0; x < len; ++x)
+		for (size_t j = 0; j < nOut; ++j) {
+			uint8_t acc = out[j][x];
+			for (size_t i = 0; i < nIn; ++i)
+				acc ^= gf->exp[gf->log[coef[j*nIn+i]] + gf->log[in[i][x]]], BENCH_CLOBBER();
+			out[j][x] = acc;
+		}
+}
+
+void
+gf_mad_scalar_table(uint8_t **out, uint8_t const *const *in, size_t nOut,
+                    size_t nIn, uint8_t const *coef, size_t len, Gf const *gf)
+{
+	for (size_t x = 0; x < len; ++x)
+		for (size_t j = 0; j < nOut; ++j) {
+			uint8_t acc = out[j][x];
+			for (size_t i = 0; i < nIn; ++i)
+				acc ^= gf->mul[coef[j*nIn+i]][in[i][x]], BENCH_CLOBBER();
+			out[j][x] = acc;
+		}
+}
+
+void
+gf_mad_scalar_table_autovec(uint8_t **out, uint8_t const *const *in, size_t nOut,
+                            size_t nIn, uint8_t const *coef, size_t len, Gf const *gf)
+{
+	for (size_t j = 0; j < nOut; ++j)
+		for (size_t i = 0; i < nIn; ++i) {
+			uint8_t *restrict o = out[j];
+			uint8_t const *restrict p = in[i];
+			uint8_t const *restrict row = gf->mul[coef[j*nIn+i]];
+			for (size_t x = 0; x < len; ++x)
+				o[x] ^= row[p[x]];
+		}
+}
+
+/* The nibble impls look up both halves of each byte in 16 byte tables with
+ * vrgather, like LUT4, the vluxei8 impls index the full product table. The
+ * tables need VLEN >= 128, below that the nibble impls run the vluxei8 ones. */
+#define IMPLS(f) \
+	f(scalar) \
+	f(scalar_table) \
+	f(scalar_table_autovec) \
+	f(rvv_nibble_m1) \
+	f(rvv_nibble_m2) \
+	f(rvv_vluxei8_m1) \
+	f(rvv_vluxei8_m2) \
+
+#define DECLARE(f) extern Func gf_mad_##f;
+IMPLS(DECLARE)
+
+#define EXTRACT(f) { #f, &gf_mad_##f, 0 },
+Impl impls[] = { IMPLS(EXTRACT) };
+
+static Gf gf;
+
+static uint8_t
+gf_mul(uint8_t a, uint8_t b)
+{
+	return gf.exp[gf.log[a] + gf.log[b]];
+}
+
+static uint8_t
+gf_inv(uint8_t a)
+{
+	return gf.exp[255 - gf.log[a]];
+}
+
+static void
+gf_init(void)
+{
+	unsigned x = 1;
+	for (size_t i = 0; i < 255; ++i) {
+		gf.exp[i] = gf.exp[i+255] = x;
+		gf.log[x] = i;
+		x = x << 1 ^ (x & 0x80 ? GF_POLY : 0);
+	}
+	gf.log[0] = 511;
+	for (size_t c = 0; c < 256; ++c) {
+		for (size_t x = 0; x < 256; ++x)
+			gf.mul[c][x] = gf_mul(c, x);
+		for (size_t x = 0; x < 16; ++x) {
+			gf.nib[c][x] = gf_mul(c, x);
+			gf.nib[c][16+x] = gf_mul(c, x << 4);
+		}
+	}
+}
+
+#define MAX_K 10
+#define MAX_M 4
+
+/* A systematic RS(k,m) code: the data shards are followed by m parity
+ * shards, whose coefficients are the Cauchy matrix 1/(i^j), for the parity
+ * row i in [k,k+m) and the data column j in [0,k), like ISA-L's
+ * gf_gen_cauchy1_matrix. Any k of the k+m shards recover the data. */
+typedef struct {
+	size_t k, m;
+	uint8_t parity[MAX_M*MAX_K];
+} Code;
+
+static void
+code_init(Code *c, size_t k, size_t m)
+{
+	c->k = k, c->m = m;
+	for (size_t i = 0; i < m; ++i)
+		for (size_t j = 0; j < k; ++j)
+			c->parity[i*k+j] = gf_inv((k + i) ^ j);
+}
+
+static void
+rs_encode(Func *f, Code const *c, uint8_t *stripe, size_t len)
+{
+	uint8_t const *in[MAX_K];
+	uint8_t *out[MAX_M];
+	for (size_t i = 0; i < c->k; ++i)
+		in[i] = stripe + i*len;
+	for (size_t i = 0; i < c->m; ++i)
+		memset(out[i] = stripe + (c->k + i)*len, 0, len);
+	f(out, in, c->m, c->k, c->parity, len, &gf);
+}
+
+/* Recovers the first m data shards into dst, from the other k-m data
+ * shards and the m parity shards. The generator rows of the survivors are
+ * inverted with Gauss-Jordan elimination, and the first m rows of the
+ * inverse reconstruct the lost shards. */
+static void
+rs_decode(Func *f, Code const *c, uint8_t *stripe, uint8_t *dst, size_t len)
+{
+	size_t k = c->k, m = c->m;
+	uint8_t a[MAX_K][MAX_K] = { 0 }, inv[MAX_K][MAX_K] = { 0 };
+	uint8_t const *in[MAX_K];
+	uint8_t *out[MAX_M];
+	for (size_t i = 0; i < k; ++i) {
+		if (i < k - m)
+			a[i][m+i] = 1;
+		else
+			memcpy(a[i], c->parity + (i - (k - m))*k, k);
+		in[i] = stripe + (m + i)*len;
+		inv[i][i] = 1;
+	}
+	for (size_t col = 0; col < k; ++col) {
+		size_t p = col;
+		while (!a[p][col])
+			++p;
+		for (size_t j = 0; j < k; ++j) {
+			uint8_t t = a[p][j]; a[p][j] = a[col][j]; a[col][j] = t;
+			t = inv[p][j]; inv[p][j] = inv[col][j]; inv[col][j] = t;
+		}
+		uint8_t s = gf_inv(a[col][col]);
+		for (size_t j = 0; j < k; ++j)
+			a[col][j] = gf_mul(a[col][j], s), inv[col][j] = gf_mul(inv[col][j], s);
+		for (size_t i = 0; i < k; ++i) {
+			uint8_t t = a[i][col];
+			if (i == col || !t)
+				continue;
+			for (size_t j = 0; j < k; ++j)
+				a[i][j] ^= gf_mul(a[col][j], t), inv[i][j] ^= gf_mul(inv[col][j], t);
+		}
+	}
+	uint8_t coef[MAX_M*MAX_K];
+	for (size_t i = 0; i < m; ++i) {
+		memcpy(coef + i*k, inv[i], k);
+		memset(out[i] = dst + i*len, 0, len);
+	}
+	f(out, in, m, k, coef, len, &gf);
+}
+
+static Code rs10_4, rs4_2;
+static uint8_t *stripe, *dst;
+static size_t outLen;
+/* the stripe whose parity decode already computed */
+static Code const *encoded;
+static size_t encodedLen;
+
+void init(void) {
+	gf_init();
+	code_init(&rs10_4, 10, 4);
+	code_init(&rs4_2, 4, 2);
+}
+
+ux checksum(size_t n) {
+	return bench_hash(0, dst, outLen);
+}
+
+BENCH_BEG(mad) {
+	static uint8_t const c = 0x8e;
+	uint8_t const *in = mem + MAX_MEM/2;
+	dst = mem, outLen = n;
+	bench_memrand(dst, n);
+	TIME f(&dst, &in, 1, 1, &c, n, &gf);
+} BENCH_END
+
+/* n is the size of the k data shards */
+#define BENCH_RS(k, m) \
+	BENCH_BEG(encode_##k##_##m) { \
+		size_t len = n / k; \
+		stripe = mem, dst = mem + k*len, outLen = m*len, encoded = 0; \
+		TIME rs_encode(f, &rs##k##_##m, stripe, len); \
+	} BENCH_END \
+	BENCH_BEG(decode_##k##_##m) { \
+		size_t len = n / k; \
+		stripe = mem, dst = mem + (k+m)*len, outLen = m*len; \
+		if (encoded != &rs##k##_##m || encodedLen != len) \
+			rs_encode(gf_mad_scalar_table, encoded = &rs##k##_##m, stripe, encodedLen = len); \
+		TIME rs_decode(f, &rs##k##_##m, stripe, dst, len); \
+	} BENCH_END
+BENCH_RS(10, 4)
+BENCH_RS(4, 2)
+
+Bench benches[] = {
+	BENCH( impls, MAX_MEM/2, "gf256 multiply-add", bench_mad ),
+	BENCH( impls, MAX_MEM/18*10, "RS(10,4) encode", bench_encode_10_4 ),
+	BENCH( impls, MAX_MEM/18*10, "RS(10,4) decode 4 lost", bench_decode_10_4 ),
+	BENCH( impls, MAX_MEM/8*4, "RS(4,2) encode", bench_encode_4_2 ),
+	BENCH( impls, MAX_MEM/8*4, "RS(4,2) decode 2 lost", bench_decode_4_2 ),
+}; BENCH_MAIN(benches)
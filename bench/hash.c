@@ -0,0 +1,333 @@
+#include "bench.h"
+#if __riscv_xlen != 32
+
+/* XXH64 and XXH3_64bits with seed 0 and the default secret, the results
+ * match the reference implementation, see
+ * https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md */
+
+#define P32_1 0x9E3779B1u
+#define P32_2 0x85EBCA77u
+#define P32_3 0xC2B2AE3Du
+#define P64_1 0x9E3779B185EBCA87u
+#define P64_2 0xC2B2AE3D27D4EB4Fu
+#define P64_3 0x165667B19E3779F9u
+#define P64_4 0x85EBCA77C2B2AE63u
+#define P64_5 0x27D4EB2F165667C5u
+#define PRIME_MX1 0x165667919E3779F9u
+#define PRIME_MX2 0x9FB21C651E98DF25u
+
+/* 16 stripes of 64 bytes per block, with the default 192 byte secret */
+#define XXH3_STRIPE 64
+#define XXH3_BLOCK (XXH3_STRIPE * 16)
+
+__attribute__((aligned(64)))
+uint8_t const xxh3_secret[192] = {
+	0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+	0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+	0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+	0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+	0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+	0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+	0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+	0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+	0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+	0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+	0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+	0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+static inline uint64_t rd64(uint8_t const *p) { uint64_t x; memcpy(&x, p, 8); return x; }
+static inline uint32_t rd32(uint8_t const *p) { uint32_t x; memcpy(&x, p, 4); return x; }
+static inline uint64_t rotl64(uint64_t x, unsigned r) { return x << r | x >> (64 - r); }
+
+static inline uint64_t
+bswap64(uint64_t x)
+{
+	x = (x & 0x00ff00ff00ff00ffu) << 8 | (x >> 8 & 0x00ff00ff00ff00ffu);
+	x = (x & 0x0000ffff0000ffffu) << 16 | (x >> 16 & 0x0000ffff0000ffffu);
+	return x << 32 | x >> 32;
+}
+
+static inline uint64_t
+mul128_fold64(uint64_t a, uint64_t b)
+{
+	unsigned __int128 x = (unsigned __int128)a * b;
+	return (uint64_t)x ^ (uint64_t)(x >> 64);
+}
+
+static inline uint64_t
+xxh64_round(uint64_t acc, uint64_t x)
+{
+	return rotl64(acc + x * P64_2, 31) * P64_1;
+}
+
+static inline uint64_t
+xxh64_avalanche(uint64_t h)
+{
+	h ^= h >> 33, h *= P64_2;
+	h ^= h >> 29, h *= P64_3;
+	return h ^ h >> 32;
+}
+
+/* Finishes XXH64 of len bytes, with the n remaining bytes at p, from the 4
+ * accumulators of the stripes, which is null for less than 32 bytes. The
+ * impls call this after their stripe loop. */
+uint64_t
+xxh64_finish(uint64_t const *acc, uint8_t const *p, size_t n, size_t len)
+{
+	uint64_t h = P64_5;
+	if (acc) {
+		h = rotl64(acc[0], 1) + rotl64(acc[1], 7) + rotl64(acc[2], 12) + rotl64(acc[3], 18);
+		for (size_t i = 0; i < 4; ++i)
+			h = (h ^ xxh64_round(0, acc[i])) * P64_1 + P64_4;
+	}
+	h += len;
+	for (; n >= 8; n -= 8, p += 8)
+		h = rotl64(h ^ xxh64_round(0, rd64(p)), 27) * P64_1 + P64_4;
+	if (n >= 4)
+		h = rotl64(h ^ rd32(p) * P64_1, 23) * P64_2 + P64_3, n -= 4, p += 4;
+	while (n--)
+		h = rotl64(h ^ *p++ * P64_5, 11) * P64_1;
+	return xxh64_avalanche(h);
+}
+
+uint64_t
+xxh64_scalar(uint8_t const *p, size_t n)
+{
+	if (n < 32)
+		return xxh64_finish(0, p, n, n);
+	uint64_t acc[4] = { P64_1 + P64_2, P64_2, 0, -P64_1 };
+	size_t i = 0;
+	for (; i + 32 <= n; i += 32)
+		for (size_t j = 0; j < 4; ++j)
+			acc[j] = xxh64_round(acc[j], rd64(p + i + j*8));
+	return xxh64_finish(acc, p + i, n - i, n);
+}
+
+static inline uint64_t
+xxh3_avalanche(uint64_t h)
+{
+	h ^= h >> 37, h *= PRIME_MX1;
+	return h ^ h >> 32;
+}
+
+static inline uint64_t
+xxh3_rrmxmx(uint64_t h, size_t len)
+{
+	h ^= rotl64(h, 49) ^ rotl64(h, 24), h *= PRIME_MX2;
+	h ^= (h >> 35) + len, h *= PRIME_MX2;
+	return h ^ h >> 28;
+}
+
+static inline uint64_t
+xxh3_mix16(uint8_t const *p, uint8_t const *s)
+{
+	return mul128_fold64(rd64(p) ^ rd64(s), rd64(p + 8) ^ rd64(s + 8));
+}
+
+static inline uint64_t
+xxh3_8(uint8_t const *p)
+{
+	uint64_t flip = rd64(xxh3_secret + 8) ^ rd64(xxh3_secret + 16);
+	return xxh3_rrmxmx(rotl64(rd64(p), 32) ^ flip, 8);
+}
+
+static inline uint64_t
+xxh3_16(uint8_t const *p)
+{
+	uint64_t lo = rd64(p) ^ rd64(xxh3_secret + 24) ^ rd64(xxh3_secret + 32);
+	uint64_t hi = rd64(p + 8) ^ rd64(xxh3_secret + 40) ^ rd64(xxh3_secret + 48);
+	return xxh3_avalanche(16 + bswap64(lo) + hi + mul128_fold64(lo, hi));
+}
+
+/* XXH3 of at most 240 bytes, the impls only differ in the long inputs */
+uint64_t
+xxh3_short(uint8_t const *p, size_t n)
+{
+	uint8_t const *s = xxh3_secret;
+	if (n == 0)
+		return xxh64_avalanche(rd64(s + 56) ^ rd64(s + 64));
+	if (n <= 3) {
+		uint32_t x = (uint32_t)p[0] << 16 | (uint32_t)p[n >> 1] << 24 | p[n - 1] | n << 8;
+		return xxh64_avalanche(x ^ (rd32(s) ^ rd32(s + 4)));
+	}
+	if (n <= 8) {
+		uint64_t x = rd32(p + n - 4) + ((uint64_t)rd32(p) << 32);
+		return xxh3_rrmxmx(x ^ (rd64(s + 8) ^ rd64(s + 16)), n);
+	}
+	if (n <= 16) {
+		uint64_t lo = rd64(p) ^ rd64(s + 24) ^ rd64(s + 32);
+		uint64_t hi = rd64(p + n - 8) ^ rd64(s + 40) ^ rd64(s + 48);
+		return xxh3_avalanche(n + bswap64(lo) + hi + mul128_fold64(lo, hi));
+	}
+	uint64_t acc = n * P64_1;
+	if (n <= 128) {
+		for (size_t i = 0; i < 4 && 32*i < n; ++i)
+			acc += xxh3_mix16(p + 16*i, s + 32*i) +
+			       xxh3_mix16(p + n - 16*(i+1), s + 32*i + 16);
+		return xxh3_avalanche(acc);
+	}
+	for (size_t i = 0; i < 8; ++i)
+		acc += xxh3_mix16(p + 16*i, s + 16*i);
+	acc = xxh3_avalanche(acc);
+	for (size_t i = 8; i < n / 16; ++i)
+		acc += xxh3_mix16(p + 16*i, s + 16*(i-8) + 3);
+	return xxh3_avalanche(acc + xxh3_mix16(p + n - 16, s + 136 - 17));
+}
+
+/* Finishes XXH3 of more than 240 bytes from the 8 accumulators */
+uint64_t
+xxh3_merge(uint64_t const *acc, size_t len)
+{
+	uint64_t h = len * P64_1;
+	for (size_t i = 0; i < 4; ++i)
+		h += mul128_fold64(acc[2*i] ^ rd64(xxh3_secret + 11 + 16*i),
+		                   acc[2*i+1] ^ rd64(xxh3_secret + 19 + 16*i));
+	return xxh3_avalanche(h);
+}
+
+static inline void
+xxh3_stripe(uint64_t *acc, uint8_t const *p, uint8_t const *s)
+{
+	for (size_t i = 0; i < 8; ++i) {
+		uint64_t x = rd64(p + 8*i), k = x ^ rd64(s + 8*i);
+		acc[i ^ 1] += x;
+		acc[i] += (k & 0xffffffff) * (k >> 32);
+	}
+}
+
+uint64_t
+xxh3_scalar(uint8_t const *p, size_t n)
+{
+	if (n <= 240)
+		return xxh3_short(p, n);
+	uint64_t acc[8] = { P32_3, P64_1, P64_2, P64_3, P64_4, P32_2, P64_5, P32_1 };
+	size_t nb = (n - 1) / XXH3_BLOCK, ns = (n - 1) % XXH3_BLOCK / XXH3_STRIPE;
+	for (size_t b = 0; b < nb; ++b, p += XXH3_BLOCK) {
+		for (size_t i = 0; i < 16; ++i)
+			xxh3_stripe(acc, p + i*XXH3_STRIPE, xxh3_secret + 8*i);
+		for (size_t i = 0; i < 8; ++i)
+			acc[i] = (acc[i] ^ acc[i] >> 47 ^ rd64(xxh3_secret + 128 + 8*i)) * P32_1;
+	}
+	for (size_t i = 0; i < ns; ++i)
+		xxh3_stripe(acc, p + i*XXH3_STRIPE, xxh3_secret + 8*i);
+	p -= nb * XXH3_BLOCK;
+	xxh3_stripe(acc, p + n - XXH3_STRIPE, xxh3_secret + 192 - XXH3_STRIPE - 7);
+	return xxh3_merge(acc, n);
+}
+
+/* Bulk hashing of n fixed size keys, like for a hash join or dedup, is the
+ * XXH3 of each key. */
+typedef void FuncKeys(uint64_t *out, uint8_t const *keys, size_t n);
+
+void
+keys8_scalar(uint64_t *out, uint8_t const *keys, size_t n)
+{
+	for (size_t i = 0; i < n; ++i)
+		out[i] = xxh3_8(keys + 8*i), BENCH_CLOBBER();
+}
+
+void
+keys8_scalar_autovec(uint64_t *out, uint8_t const *keys, size_t n)
+{
+	for (size_t i = 0; i < n; ++i)
+		out[i] = xxh3_8(keys + 8*i);
+}
+
+void
+keys16_scalar(uint64_t *out, uint8_t const *keys, size_t n)
+{
+	for (size_t i = 0; i < n; ++i)
+		out[i] = xxh3_16(keys + 16*i), BENCH_CLOBBER();
+}
+
+void
+keys16_scalar_autovec(uint64_t *out, uint8_t const *keys, size_t n)
+{
+	for (size_t i = 0; i < n; ++i)
+		out[i] = xxh3_16(keys + 16*i);
+}
+
+typedef uint64_t Func(uint8_t const *p, size_t n);
+
+/* The rvv impls of the long hashes keep the XXH64 or XXH3 accumulators in
+ * the lanes of a single vector, whose LMUL is picked for the VLEN, the
+ * bulk impls hash one key per lane. */
+#define IMPLS(f) \
+	f(scalar) \
+	IF_VE64(f(rvv)) \
+
+#define IMPLS_KEYS(f,T) \
+	f(T##_scalar) \
+	f(T##_scalar_autovec) \
+	IF_VE64(f(T##_rvv_m1)) \
+	IF_VE64(f(T##_rvv_m2)) \
+	IF_VE64(f(T##_rvv_m4)) \
+
+#define DECLARE(f) extern Func xxh64_##f, xxh3_##f;
+IMPLS(DECLARE)
+#define DECLARE_KEYS(f) extern FuncKeys f;
+IMPLS_KEYS(DECLARE_KEYS, keys8)
+IMPLS_KEYS(DECLARE_KEYS, keys16)
+
+#define EXTRACT64(f) { #f, &xxh64_##f, 0 },
+#define EXTRACT3(f) { #f, &xxh3_##f, 0 },
+#define EXTRACT_KEYS(f) { #f, &f, 0 },
+Impl implsXxh64[] = { IMPLS(EXTRACT64) };
+Impl implsXxh3[] = { IMPLS(EXTRACT3) };
+Impl implsKeys8[] = { IMPLS_KEYS(EXTRACT_KEYS, keys8) };
+Impl implsKeys16[] = { IMPLS_KEYS(EXTRACT_KEYS, keys16) };
+
+static uint64_t last;
+static uint64_t *out;
+static size_t outLen;
+
+void init(void) { }
+
+ux checksum(size_t n) {
+	return last + bench_hash(0, out, outLen);
+}
+
+BENCH_BEG(long) {
+	outLen = 0;
+	TIME last = f(mem, n);
+} BENCH_END
+
+/* independent inputs, each starting on a cache line */
+BENCH_BEG(small) {
+	size_t stride = (n + 63) & -64;
+	outLen = last = 0;
+	TIME for (size_t k = 0; k < CHAIN_CALLS; ++k)
+		last ^= f(mem + k*stride, n);
+} BENCH_END
+
+/* n is the size of the keys */
+BENCH_BEG(keys8) {
+	FuncKeys *g = _func; (void)f;
+	out = (uint64_t*)mem, outLen = n, last = 0;
+	TIME g(out, mem + MAX_MEM/2, n / 8);
+} BENCH_END
+
+BENCH_BEG(keys16) {
+	FuncKeys *g = _func; (void)f;
+	out = (uint64_t*)mem, outLen = n / 2, last = 0;
+	TIME g(out, mem + MAX_MEM/2, n / 16);
+} BENCH_END
+
+GUARD_BEG(long) {
+	return f(p, n);
+} GUARD_END
+
+Bench benches[] = {
+	BENCH( implsXxh64, MAX_MEM, "xxh64", bench_long, guard_long ),
+	BENCH( implsXxh3, MAX_MEM, "xxh3 64", bench_long, guard_long ),
+	BENCH( implsXxh3, 1024, "xxh3 64 small inputs", bench_small, .calls = CHAIN_CALLS ),
+	BENCH( implsKeys8, MAX_MEM/2, "xxh3 8 byte keys", bench_keys8 ),
+	BENCH( implsKeys16, MAX_MEM/2, "xxh3 16 byte keys", bench_keys16 ),
+}; BENCH_MAIN(benches)
+#else
+void init(void) {}
+Impl impls[] = {};
+Bench benches[] = {};
+BENCH_MAIN(benches)
+#endif
@@ -0,0 +1,101 @@
+#include "bench.h"
+
+void *
+memchr_scalar(void const *src, int c, size_t n)
+{
+	unsigned char const *s = src;
+	for (; n && *s != (unsigned char)c; s++, n--) BENCH_CLOBBER();
+	return n ? (void*)s : 0;
+}
+
+void *
+memchr_scalar_autovec(void const *src, int c, size_t n)
+{
+	unsigned char const *s = src;
+	for (; n && *s != (unsigned char)c; s++, n--);
+	return n ? (void*)s : 0;
+}
+
+/* https://git.musl-libc.org/cgit/musl/tree/src/string/memchr.c */
+#define SS (sizeof(size_t))
+#define ALIGN (sizeof(size_t)-1)
+#define ONES ((size_t)-1/UCHAR_MAX)
+#define HIGHS (ONES * (UCHAR_MAX/2+1))
+#define HASZERO(x) (((x)-ONES) & ~(x) & HIGHS)
+void *
+memchr_musl(void const *src, int c, size_t n)
+{
+	unsigned char const *s = src;
+	c = (unsigned char)c;
+#ifdef __GNUC__
+	for (; ((uintptr_t)s & ALIGN) && n && *s != c; s++, n--);
+	if (n && *s != c) {
+		typedef size_t __attribute__((__may_alias__)) word;
+		word const *w;
+		size_t k = ONES * c;
+		for (w = (void const*)s; n>=SS && !HASZERO(*w^k); w++, n-=SS);
+		s = (void const*)w;
+	}
+#endif
+	for (; n && *s != c; s++, n--);
+	return n ? (void*)s : 0;
+}
+
+#define memchr_libc memchr
+
+#define IMPLS(f) \
+	f(scalar) \
+	f(scalar_autovec) \
+	IFHOSTED(f(libc)) \
+	f(musl) \
+	MX(f, rvv) \
+	MX(f, rvv_vlmax) \
+
+typedef void *Func(void const *src, int c, size_t n);
+
+#define DECLARE(f) extern Func memchr_##f;
+IMPLS(DECLARE)
+
+#define EXTRACT(f) { #f, &memchr_##f, 0 },
+Impl impls[] = { IMPLS(EXTRACT) };
+
+ux last;
+unsigned char c;
+
+void init(void) {
+	c = bench_urand();
+	for (size_t i = 0; i < MAX_MEM; ++i)
+		mem[i] += mem[i] == c; // remove c
+}
+
+ux checksum(size_t n) { return last; }
+
+/* no match, the whole input is searched */
+BENCH_BEG(base) {
+	unsigned char *p = mem + (bench_urand() % 511);
+	unsigned char *r;
+	TIME r = f(p, c, n);
+	last = r ? r - p : -1;
+} BENCH_END
+
+/* match at a uniformly random position */
+BENCH_BEG(random) {
+	unsigned char *p = mem + (bench_urand() % 511);
+	unsigned char *r;
+	size_t pos = bench_urand() % n;
+	p[pos] = c;
+	TIME r = f(p, c, n);
+	last = r ? r - p : -1;
+	p[pos] = c + 1;
+} BENCH_END
+
+GUARD_BEG(base) {
+	unsigned char *r = f(p, n ? p[n-1] : 0, n);
+	return r ? r - p : -1;
+} GUARD_END
+
+Bench benches[] = {
+	BENCH( impls, MAX_MEM - 521, "memchr", bench_base, guard_base ),
+	BENCH( impls, MAX_MEM - 521, "memchr random match", bench_random ),
+}; BENCH_MAIN(benches)
+
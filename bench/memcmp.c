@@ -0,0 +1,76 @@
+#include "bench.h"
+
+int
+memcmp_scalar(void const *vl, void const *vr, size_t n)
+{
+	unsigned char const *l = vl, *r = vr;
+	for (; n && *l == *r; n--, l++, r++) BENCH_CLOBBER();
+	return n ? *l-*r : 0;
+}
+
+/* https://git.musl-libc.org/cgit/musl/tree/src/string/memcmp.c */
+int
+memcmp_musl(void const *vl, void const *vr, size_t n)
+{
+	unsigned char const *l = vl, *r = vr;
+	for (; n && *l == *r; n--, l++, r++);
+	return n ? *l-*r : 0;
+}
+
+#define memcmp_libc memcmp
+
+#define IMPLS(f) \
+	f(scalar) \
+	IFHOSTED(f(libc)) \
+	f(musl) \
+	MX(f, rvv) \
+	MX(f, rvv_vlmax) \
+
+typedef int Func(void const *vl, void const *vr, size_t n);
+
+#define DECLARE(f) extern Func memcmp_##f;
+IMPLS(DECLARE)
+
+#define EXTRACT(f) { #f, &memcmp_##f, 0 },
+Impl impls[] = { IMPLS(EXTRACT) };
+
+uint8_t *a, *b;
+ux last;
+
+void init(void) { }
+
+/* only the sign is specified */
+ux checksum(size_t n) { return (int)last < 0 ? -1 : (int)last > 0; }
+
+void common(size_t n) {
+	a = mem + (bench_urand() & 255);
+	b = mem + MAX_MEM/2 + (bench_urand() & 255);
+	memcpy(b, a, n);
+}
+
+/* equal inputs, all bytes are compared */
+BENCH_BEG(base) {
+	common(n);
+	TIME last = f(a, b, n);
+} BENCH_END
+
+/* mismatch at a uniformly random position */
+BENCH_BEG(random) {
+	common(n);
+	size_t pos = bench_urand() % n;
+	b[pos] = a[pos] + 1 + bench_urand() % 255;
+	TIME last = f(a, b, n);
+} BENCH_END
+
+GUARD_BEG(base) {
+	memcpy(mem, p, n);
+	if (n) mem[n-1] ^= 1;
+	int r = f(p, mem, n);
+	return r < 0 ? -1 : r > 0;
+} GUARD_END
+
+Bench benches[] = {
+	BENCH( impls, MAX_MEM/2 - 521, "memcmp", bench_base, guard_base ),
+	BENCH( impls, MAX_MEM/2 - 521, "memcmp random mismatch", bench_random ),
+}; BENCH_MAIN(benches)
+
@@ -170,10 +170,7 @@ ux last;
 void init(void) { }
 
 ux checksum(size_t n) {
-	ux sum = last;
-	for (size_t i = 0; i < n+9; ++i)
-		sum = uhash(sum) + dest[i];
-	return sum;
+	return bench_hash(last, dest, n+9);
 }
 
 void common(size_t n, size_t dOff, size_t sOff) {
@@ -191,8 +188,37 @@ BENCH_BEG(aligned) {
 	TIME last = (uintptr_t)f(dest, src, n);
 } BENCH_END
 
+/* every copy reads the output of the previous one */
+BENCH_BEG(latency) {
+	common(n, bench_urand() & 255, bench_urand() & 255);
+	uint8_t *a = src, *b = dest;
+	TIME for (size_t k = 0; k < CHAIN_CALLS; ++k) {
+		uint8_t *t = f(b, a, n);
+		b = a; a = t;
+	}
+	last = a - mem;
+} BENCH_END
+
+BENCH_BEG(throughput) {
+	common(n * CHAIN_CALLS, bench_urand() & 255, bench_urand() & 255);
+	TIME for (size_t k = 0; k < CHAIN_CALLS; ++k)
+		last = (uintptr_t)f(dest + k*n, src + k*n, n);
+} BENCH_END
+
+GUARD_BEG(base) {
+	memset(mem, 0, n+9);
+	return bench_hash((uintptr_t)f(mem, p, n) - (uintptr_t)mem, mem, n+9);
+} GUARD_END
+
+REPLAY_BEG(base) {
+	TIME for (ReplayCall const *c = calls; c != calls + nCalls; ++c)
+		last = (uintptr_t)f(mem + c->dOff, mem + MAX_MEM/2 + c->sOff, c->n);
+} REPLAY_END
+
 Bench benches[] = {
-	BENCH( impls, MAX_MEM/2 - 521, "memcpy", bench_base ),
-	BENCH( impls, MAX_MEM/2 - 521, "memcpy aligned", bench_aligned )
+	BENCH( impls, MAX_MEM/2 - 521, "memcpy", bench_base, guard_base, replay_base ),
+	BENCH( impls, MAX_MEM/2 - 521, "memcpy aligned", bench_aligned ),
+	BENCH( impls, 1024, "memcpy latency", bench_latency, .calls = CHAIN_CALLS ),
+	BENCH( impls, 1024, "memcpy throughput", bench_throughput, .calls = CHAIN_CALLS )
 }; BENCH_MAIN(benches)
 
@@ -0,0 +1,133 @@
+#include "bench.h"
+
+void *
+memmove_scalar(void *dest, void const *src, size_t n)
+{
+	unsigned char *d = dest;
+	unsigned char const *s = src;
+	if (d < s)
+		while (n--) *d++ = *s++, BENCH_CLOBBER();
+	else
+		while (n--) d[n] = s[n], BENCH_CLOBBER();
+	return dest;
+}
+
+void *
+memmove_scalar_autovec(void *dest, void const *src, size_t n)
+{
+	unsigned char *d = dest;
+	unsigned char const *s = src;
+	if (d < s)
+		while (n--) *d++ = *s++;
+	else
+		while (n--) d[n] = s[n];
+	return dest;
+}
+
+/* https://git.musl-libc.org/cgit/musl/tree/src/string/memmove.c */
+void *
+memmove_musl(void *dest, void const *src, size_t n)
+{
+	char *d = dest;
+	char const *s = src;
+
+#ifdef __GNUC__
+	typedef __attribute__((__may_alias__)) size_t WT;
+#define WS (sizeof(WT))
+#endif
+
+	if (d==s) return d;
+	if ((uintptr_t)s-(uintptr_t)d-n <= -2*n) return memcpy(d, s, n);
+
+	if (d<s) {
+#ifdef __GNUC__
+		if ((uintptr_t)s % WS == (uintptr_t)d % WS) {
+			while ((uintptr_t)d % WS) {
+				if (!n--) return dest;
+				*d++ = *s++;
+			}
+			for (; n>=WS; n-=WS, d+=WS, s+=WS) *(WT *)d = *(WT *)s;
+		}
+#endif
+		for (; n; n--) *d++ = *s++;
+	} else {
+#ifdef __GNUC__
+		if ((uintptr_t)s % WS == (uintptr_t)d % WS) {
+			while ((uintptr_t)(d+n) % WS) {
+				if (!n--) return dest;
+				d[n] = s[n];
+			}
+			while (n>=WS) n-=WS, *(WT *)(d+n) = *(WT *)(s+n);
+		}
+#endif
+		while (n) n--, d[n] = s[n];
+	}
+
+	return dest;
+}
+
+#define memmove_libc memmove
+
+#define IMPLS(f) \
+	IFHOSTED(f(libc)) \
+	f(musl) \
+	f(scalar) \
+	f(scalar_autovec) \
+	MX(f, rvv) \
+	MX(f, rvv_vlse) \
+	MX(f, rvv_stage) \
+
+typedef void *Func(void *dest, void const *src, size_t n);
+
+#define DECLARE(f) extern Func memmove_##f;
+IMPLS(DECLARE)
+
+#define EXTRACT(f) { #f, &memmove_##f, 0 },
+Impl impls[] = { IMPLS(EXTRACT) };
+
+uint8_t *dest, *src, *lo;
+size_t len;
+ux last;
+
+void init(void) { }
+
+ux checksum(size_t n) {
+	return bench_hash(last, lo, len);
+}
+
+/* dest = src + dist, the memory is refilled, because overlapping moves
+ * modify their own source, which would break validation */
+void common(size_t n, long dist) {
+	src = mem + MAX_MEM/2 + (bench_urand() & 255);
+	dest = src + dist;
+	lo = dist < 0 ? dest : src;
+	len = n + (dist < 0 ? -dist : dist) + 9;
+	bench_memrand(lo, len);
+}
+
+#define OVERLAP(name, dist) \
+	BENCH_BEG(name) { \
+		common(n, dist); \
+		TIME last = (uintptr_t)f(dest, src, n); \
+	} BENCH_END
+
+OVERLAP(none, (long)(n + (bench_urand() & 255)))
+OVERLAP(fwd_1, -1)
+OVERLAP(fwd_64, -64)
+OVERLAP(fwd_half, -(long)(n/2 + 1))
+OVERLAP(bwd_1, 1)
+OVERLAP(bwd_64, 64)
+OVERLAP(bwd_half, (long)(n/2 + 1))
+
+#define N_OVERLAP (MAX_MEM/8)
+
+Bench benches[] = {
+	BENCH( impls, MAX_MEM/4 - 521, "memmove", bench_none ),
+	BENCH( impls, N_OVERLAP, "memmove dest=src-1", bench_fwd_1 ),
+	BENCH( impls, N_OVERLAP, "memmove dest=src-64", bench_fwd_64 ),
+	BENCH( impls, N_OVERLAP, "memmove dest=src-n/2", bench_fwd_half ),
+	BENCH( impls, N_OVERLAP, "memmove dest=src+1", bench_bwd_1 ),
+	BENCH( impls, N_OVERLAP, "memmove dest=src+64", bench_bwd_64 ),
+	BENCH( impls, N_OVERLAP, "memmove dest=src+n/2", bench_bwd_half ),
+}; BENCH_MAIN(benches)
+
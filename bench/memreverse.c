@@ -37,10 +37,7 @@ uint8_t *dest, *src;
 void init(void) { }
 
 ux checksum(size_t n) {
-	ux sum = 0;
-	for (size_t i = 0; i < n+9; ++i)
-		sum = uhash(sum) + dest[i];
-	return sum;
+	return bench_hash(0, dest, n+9);
 }
 
 void common(size_t n, size_t dOff, size_t sOff) {
@@ -53,7 +50,18 @@ BENCH_BEG(base) {
 	TIME f(dest, src, n);
 } BENCH_END
 
+GUARD_BEG(base) {
+	memset(mem, 0, n+9);
+	f(mem, p, n);
+	return bench_hash(0, mem, n+9);
+} GUARD_END
+
+REPLAY_BEG(base) {
+	TIME for (ReplayCall const *c = calls; c != calls + nCalls; ++c)
+		f(mem + c->dOff, mem + MAX_MEM/2 + c->sOff, c->n);
+} REPLAY_END
+
 Bench benches[] = {
-	BENCH( impls, MAX_MEM/2 - 521, "memreverse", bench_base ),
+	BENCH( impls, MAX_MEM/2 - 521, "memreverse", bench_base, guard_base, replay_base ),
 }; BENCH_MAIN(benches)
 
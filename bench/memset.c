@@ -136,10 +136,7 @@ char c;
 void init(void) { c = bench_urand(); }
 
 ux checksum(size_t n) {
-	ux sum = last;
-	for (size_t i = 0; i < n+9; ++i)
-		sum = uhash(sum) + dest[i];
-	return sum;
+	return bench_hash(last, dest, n+9);
 }
 
 void common(size_t n, size_t off) {
@@ -157,8 +154,13 @@ BENCH_BEG(aligned) {
 	TIME last = (uintptr_t)f(dest, c, n);
 } BENCH_END
 
+REPLAY_BEG(base) {
+	TIME for (ReplayCall const *r = calls; r != calls + nCalls; ++r)
+		last = (uintptr_t)f(mem + r->dOff, c, r->n);
+} REPLAY_END
+
 Bench benches[] = {
-	BENCH( impls, MAX_MEM - 521, "memset", bench_base ),
+	BENCH( impls, MAX_MEM - 521, "memset", bench_base, .replay = replay_base ),
 	BENCH( impls, MAX_MEM - 521, "memset aligned", bench_aligned )
 }; BENCH_MAIN(benches)
 
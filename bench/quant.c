@@ -0,0 +1,187 @@
+#include "bench.h"
+
+/* The per-tensor impls only read the first scale and zero-point, the
+ * per-channel impls take n as a multiple of the channels, which are the
+ * innermost dimension. */
+typedef struct {
+	size_t channels;
+	float *scale, *inv;
+	int8_t *zp;
+} Quant;
+
+/* round to nearest even for |x| <= 2^22, in the default rounding mode */
+static inline float
+round_even(float x)
+{
+	return (x + 12582912.0f) - 12582912.0f;
+}
+
+static inline int8_t
+quant(float x, float inv, int8_t zp)
+{
+	float v = x * inv;
+	v = v < -512 ? -512 : v > 512 ? 512 : v;
+	int32_t q = (int32_t)round_even(v) + zp;
+	return q < -128 ? -128 : q > 127 ? 127 : q;
+}
+
+void
+quant_tensor_scalar(void *dst, void const *src, size_t n, Quant const *q)
+{
+	int8_t *d = dst;
+	float const *s = src;
+	for (size_t i = 0; i < n; ++i)
+		d[i] = quant(s[i], q->inv[0], q->zp[0]), BENCH_CLOBBER();
+}
+
+void
+quant_tensor_scalar_autovec(void *dst, void const *src, size_t n, Quant const *q)
+{
+	int8_t *d = dst;
+	float const *s = src;
+	float inv = q->inv[0];
+	int8_t zp = q->zp[0];
+	for (size_t i = 0; i < n; ++i)
+		d[i] = quant(s[i], inv, zp);
+}
+
+void
+quant_channel_scalar(void *dst, void const *src, size_t n, Quant const *q)
+{
+	int8_t *d = dst;
+	float const *s = src;
+	for (size_t i = 0; i < n; i += q->channels)
+		for (size_t j = 0; j < q->channels; ++j)
+			d[i+j] = quant(s[i+j], q->inv[j], q->zp[j]), BENCH_CLOBBER();
+}
+
+void
+quant_channel_scalar_autovec(void *dst, void const *src, size_t n, Quant const *q)
+{
+	int8_t *d = dst;
+	float const *s = src;
+	size_t c = q->channels;
+	for (size_t i = 0; i < n; i += c)
+		for (size_t j = 0; j < c; ++j)
+			d[i+j] = quant(s[i+j], q->inv[j], q->zp[j]);
+}
+
+void
+dequant_tensor_scalar(void *dst, void const *src, size_t n, Quant const *q)
+{
+	float *d = dst;
+	int8_t const *s = src;
+	for (size_t i = 0; i < n; ++i)
+		d[i] = (s[i] - q->zp[0]) * q->scale[0], BENCH_CLOBBER();
+}
+
+void
+dequant_tensor_scalar_autovec(void *dst, void const *src, size_t n, Quant const *q)
+{
+	float *d = dst;
+	int8_t const *s = src;
+	float scale = q->scale[0];
+	int8_t zp = q->zp[0];
+	for (size_t i = 0; i < n; ++i)
+		d[i] = (s[i] - zp) * scale;
+}
+
+void
+dequant_channel_scalar(void *dst, void const *src, size_t n, Quant const *q)
+{
+	float *d = dst;
+	int8_t const *s = src;
+	for (size_t i = 0; i < n; i += q->channels)
+		for (size_t j = 0; j < q->channels; ++j)
+			d[i+j] = (s[i+j] - q->zp[j]) * q->scale[j], BENCH_CLOBBER();
+}
+
+void
+dequant_channel_scalar_autovec(void *dst, void const *src, size_t n, Quant const *q)
+{
+	float *d = dst;
+	int8_t const *s = src;
+	size_t c = q->channels;
+	for (size_t i = 0; i < n; i += c)
+		for (size_t j = 0; j < c; ++j)
+			d[i+j] = (s[i+j] - q->zp[j]) * q->scale[j];
+}
+
+#define IMPLS(f,T) \
+	f(T##_scalar) \
+	f(T##_scalar_autovec) \
+	MX(f, T##_rvv) \
+
+typedef void Func(void *dst, void const *src, size_t n, Quant const *q);
+
+#define DECLARE(f) extern Func f;
+IMPLS(DECLARE, quant_tensor)
+IMPLS(DECLARE, quant_channel)
+IMPLS(DECLARE, dequant_tensor)
+IMPLS(DECLARE, dequant_channel)
+
+#define EXTRACT(f) { #f, &f, 0 },
+Impl implsQuantTensor[] = { IMPLS(EXTRACT, quant_tensor) };
+Impl implsQuantChannel[] = { IMPLS(EXTRACT, quant_channel) };
+Impl implsDequantTensor[] = { IMPLS(EXTRACT, dequant_tensor) };
+Impl implsDequantChannel[] = { IMPLS(EXTRACT, dequant_channel) };
+
+#define CHANNELS 96
+
+static float scale[CHANNELS], inv[CHANNELS];
+static int8_t zp[CHANNELS];
+static Quant q = { CHANNELS, scale, inv, zp };
+
+static uint8_t *dst, *src, *fsrc;
+static size_t last;
+
+void init(void) {
+	dst = mem;
+	src = mem + MAX_MEM/4;
+	fsrc = mem + MAX_MEM/2;
+	for (size_t i = 0; i < CHANNELS; ++i) {
+		scale[i] = 0.01f + bench_urandf();
+		inv[i] = 1 / scale[i];
+		zp[i] = (int)(bench_urand() % 64) - 32;
+	}
+	/* some values clip at every scale */
+	float *f = (float*)fsrc;
+	for (size_t i = 0; i < MAX_MEM/4/sizeof(float); ++i)
+		f[i] = (bench_urandf() - 0.5f) * 512;
+}
+
+ux checksum(size_t n) {
+	return bench_hash(0, dst, last);
+}
+
+BENCH_BEG(quant_tensor) {
+	n /= sizeof(float);
+	last = n;
+	TIME f(dst, fsrc, n, &q);
+} BENCH_END
+
+BENCH_BEG(quant_channel) {
+	n = n / sizeof(float) / CHANNELS * CHANNELS;
+	last = n;
+	TIME f(dst, fsrc, n, &q);
+} BENCH_END
+
+BENCH_BEG(dequant_tensor) {
+	n /= sizeof(float);
+	last = n * sizeof(float);
+	TIME f(dst, src, n, &q);
+} BENCH_END
+
+BENCH_BEG(dequant_channel) {
+	n = n / sizeof(float) / CHANNELS * CHANNELS;
+	last = n * sizeof(float);
+	TIME f(dst, src, n, &q);
+} BENCH_END
+
+/* sizes in bytes of f32 */
+Bench benches[] = {
+	BENCH( implsQuantTensor, MAX_MEM/4, "quantize f32 to i8 per-tensor", bench_quant_tensor ),
+	BENCH( implsQuantChannel, MAX_MEM/4, "quantize f32 to i8 per-channel", bench_quant_channel ),
+	BENCH( implsDequantTensor, MAX_MEM/4, "dequantize i8 to f32 per-tensor", bench_dequant_tensor ),
+	BENCH( implsDequantChannel, MAX_MEM/4, "dequantize i8 to f32 per-channel", bench_dequant_channel ),
+}; BENCH_MAIN(benches)
@@ -0,0 +1,113 @@
+#include "bench.h"
+
+/* Inclusive prefix sums of the n elements at src into dst. The segmented
+ * scans restart at every element with a non-zero flag, the other scans
+ * ignore the flags. */
+typedef void Func(void *dst, void const *src, uint8_t const *flags, size_t n);
+
+void
+scan_u8_scalar(void *dst, void const *src, uint8_t const *flags, size_t n)
+{
+	uint8_t *d = dst, sum = 0;
+	uint8_t const *s = src;
+	for (size_t i = 0; i < n; ++i)
+		d[i] = sum += s[i], BENCH_CLOBBER();
+}
+
+void
+scan_u32_scalar(void *dst, void const *src, uint8_t const *flags, size_t n)
+{
+	uint32_t *d = dst, sum = 0;
+	uint32_t const *s = src;
+	for (size_t i = 0; i < n; ++i)
+		d[i] = sum += s[i], BENCH_CLOBBER();
+}
+
+void
+scan_f32_scalar(void *dst, void const *src, uint8_t const *flags, size_t n)
+{
+	float *d = dst, sum = 0;
+	float const *s = src;
+	for (size_t i = 0; i < n; ++i)
+		d[i] = sum += s[i], BENCH_CLOBBER();
+}
+
+void
+scan_segmented_u32_scalar(void *dst, void const *src, uint8_t const *flags, size_t n)
+{
+	uint32_t *d = dst, sum = 0;
+	uint32_t const *s = src;
+	for (size_t i = 0; i < n; ++i) {
+		sum = flags[i] ? s[i] : sum + s[i];
+		d[i] = sum, BENCH_CLOBBER();
+	}
+}
+
+#define IMPLS(f,T) \
+	f(T##_scalar) \
+	MX(f, T##_rvv) \
+
+#define DECLARE(f) extern Func scan_##f;
+IMPLS(DECLARE, u8)
+IMPLS(DECLARE, u32)
+IMPLS(DECLARE, f32)
+IMPLS(DECLARE, segmented_u32)
+
+#define EXTRACT(f) { #f, &scan_##f, 0 },
+Impl implsU8[] = { IMPLS(EXTRACT, u8) };
+Impl implsU32[] = { IMPLS(EXTRACT, u32) };
+Impl implsF32[] = { IMPLS(EXTRACT, f32) };
+Impl implsSeg[] = { IMPLS(EXTRACT, segmented_u32) };
+
+static uint8_t *dst, *src, *fsrc, *flags;
+static size_t last;
+
+void init(void) {
+	dst = mem;
+	src = mem + MAX_MEM/4;
+	fsrc = mem + MAX_MEM/2;
+	flags = mem + MAX_MEM*3/4;
+	/* Small integers, whose sums stay below 2^24, sum exactly, so the
+	 * order of the additions doesn't change the result. */
+	float *f = (float*)fsrc;
+	for (size_t i = 0; i < MAX_MEM/4/sizeof(float); ++i)
+		f[i] = bench_urand() & 7;
+	/* segments of 1 to 64 elements */
+	memset(flags, 0, MAX_MEM/4);
+	for (size_t i = 0; i < MAX_MEM/4; i += 1 + bench_urand() % 64)
+		flags[i] = 1;
+}
+
+ux checksum(size_t n) {
+	return bench_hash(0, dst, last);
+}
+
+BENCH_BEG(u8) {
+	last = n;
+	TIME f(dst, src, flags, n);
+} BENCH_END
+
+BENCH_BEG(u32) {
+	n /= sizeof(uint32_t);
+	last = n * sizeof(uint32_t);
+	TIME f(dst, src, flags, n);
+} BENCH_END
+
+BENCH_BEG(f32) {
+	n /= sizeof(float);
+	last = n * sizeof(float);
+	TIME f(dst, fsrc, flags, n);
+} BENCH_END
+
+BENCH_BEG(segmented) {
+	n /= sizeof(uint32_t);
+	last = n * sizeof(uint32_t);
+	TIME f(dst, src, flags, n);
+} BENCH_END
+
+Bench benches[] = {
+	BENCH( implsU8, MAX_MEM/4, "prefix sum u8", bench_u8 ),
+	BENCH( implsU32, MAX_MEM/4, "prefix sum u32", bench_u32 ),
+	BENCH( implsF32, MAX_MEM/4, "prefix sum f32", bench_f32 ),
+	BENCH( implsSeg, MAX_MEM/4, "segmented prefix sum u32", bench_segmented ),
+}; BENCH_MAIN(benches)
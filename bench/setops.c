@@ -0,0 +1,188 @@
+#include "bench.h"
+
+/* Intersection and union of sorted sets of u32, like the posting lists of
+ * a search index. Both write the result to dst and return its size. */
+typedef size_t Func(uint32_t *dst, uint32_t const *a, size_t na,
+                    uint32_t const *b, size_t nb);
+
+size_t
+intersect_scalar(uint32_t *dst, uint32_t const *a, size_t na,
+                 uint32_t const *b, size_t nb)
+{
+	size_t i = 0, j = 0, k = 0;
+	while (i < na && j < nb) {
+		if (a[i] < b[j])
+			++i;
+		else if (a[i] > b[j])
+			++j;
+		else
+			dst[k++] = a[i++], ++j;
+		BENCH_CLOBBER();
+	}
+	return k;
+}
+
+size_t
+intersect_scalar_branchless(uint32_t *dst, uint32_t const *a, size_t na,
+                            uint32_t const *b, size_t nb)
+{
+	size_t i = 0, j = 0, k = 0;
+	while (i < na && j < nb) {
+		uint32_t x = a[i], y = b[j];
+		dst[k] = x;
+		k += x == y, i += x <= y, j += y <= x;
+		BENCH_CLOBBER();
+	}
+	return k;
+}
+
+/* Looks up each element of the smaller set in the larger one, with an
+ * exponential search from the previous position, followed by a binary
+ * search. The rvv impls finish the binary search on a single vector. */
+size_t
+intersect_scalar_gallop(uint32_t *dst, uint32_t const *a, size_t na,
+                        uint32_t const *b, size_t nb)
+{
+	if (na > nb) {
+		uint32_t const *t = a; a = b, b = t;
+		size_t tn = na; na = nb, nb = tn;
+	}
+	size_t j = 0, k = 0;
+	for (size_t i = 0; i < na && j < nb; ++i) {
+		uint32_t x = a[i];
+		size_t s = 1, hi;
+		/* every b before j is below x */
+		while (j + s < nb && b[j+s-1] < x)
+			j += s, s *= 2, BENCH_CLOBBER();
+		hi = j + s < nb ? j + s : nb;
+		while (j < hi) {
+			size_t mid = j + (hi - j) / 2;
+			if (b[mid] < x)
+				j = mid + 1;
+			else
+				hi = mid;
+			BENCH_CLOBBER();
+		}
+		if (j < nb && b[j] == x)
+			dst[k++] = x;
+	}
+	return k;
+}
+
+size_t
+union_scalar(uint32_t *dst, uint32_t const *a, size_t na,
+             uint32_t const *b, size_t nb)
+{
+	size_t i = 0, j = 0, k = 0;
+	while (i < na && j < nb) {
+		if (a[i] < b[j])
+			dst[k++] = a[i++];
+		else if (a[i] > b[j])
+			dst[k++] = b[j++];
+		else
+			dst[k++] = a[i++], ++j;
+		BENCH_CLOBBER();
+	}
+	while (i < na)
+		dst[k++] = a[i++], BENCH_CLOBBER();
+	while (j < nb)
+		dst[k++] = b[j++], BENCH_CLOBBER();
+	return k;
+}
+
+size_t
+union_scalar_branchless(uint32_t *dst, uint32_t const *a, size_t na,
+                        uint32_t const *b, size_t nb)
+{
+	size_t i = 0, j = 0, k = 0;
+	while (i < na && j < nb) {
+		uint32_t x = a[i], y = b[j];
+		dst[k++] = x < y ? x : y;
+		i += x <= y, j += y <= x;
+		BENCH_CLOBBER();
+	}
+	while (i < na)
+		dst[k++] = a[i++], BENCH_CLOBBER();
+	while (j < nb)
+		dst[k++] = b[j++], BENCH_CLOBBER();
+	return k;
+}
+
+/* The allpairs impls compare a vector of a against every element of a
+ * vector of b with vmseq, and advance the one with the smaller maximum.
+ * The merge impls place the elements of a vector of a and of b, up to the
+ * smaller maximum, by counting the elements of the other vector below
+ * them, scatter them and drop the duplicates with vcompress. Both finish
+ * with the scalar impls. */
+#define IMPLS_INTERSECT(f) \
+	f(scalar) \
+	f(scalar_branchless) \
+	f(scalar_gallop) \
+	f(rvv_allpairs_m1) \
+	f(rvv_allpairs_m2) \
+	f(rvv_gallop_m1) \
+	f(rvv_gallop_m2) \
+
+#define IMPLS_UNION(f) \
+	f(scalar) \
+	f(scalar_branchless) \
+	f(rvv_merge_m1) \
+	f(rvv_merge_m2) \
+
+#define DECLARE_INTERSECT(f) extern Func intersect_##f;
+#define DECLARE_UNION(f) extern Func union_##f;
+IMPLS_INTERSECT(DECLARE_INTERSECT)
+IMPLS_UNION(DECLARE_UNION)
+
+#define EXTRACT_INTERSECT(f) { #f, &intersect_##f, 0 },
+#define EXTRACT_UNION(f) { #f, &union_##f, 0 },
+Impl implsIntersect[] = { IMPLS_INTERSECT(EXTRACT_INTERSECT) };
+Impl implsUnion[] = { IMPLS_UNION(EXTRACT_UNION) };
+
+static uint32_t *dst, *a, *b;
+static size_t last;
+
+void init(void) { dst = (uint32_t*)mem; }
+
+ux checksum(size_t n) {
+	return bench_hash(last, dst, last * sizeof *dst);
+}
+
+/* b has nb elements with random gaps of 1 to 16, and a has one element
+ * in each of its na ranges of b, which is the element of b with overlap
+ * percent probability, and otherwise one above it. */
+static void
+gen_sets(size_t na, size_t nb, unsigned overlap)
+{
+	b = (uint32_t*)(mem + MAX_MEM/2), a = b + nb;
+	for (size_t i = 0, x = 0; i < nb; ++i)
+		b[i] = x += 1 + bench_urand() % 16;
+	for (size_t i = 0; i < na; ++i) {
+		size_t beg = i*nb / na, end = (i+1)*nb / na;
+		size_t j = beg + bench_urand() % (end - beg);
+		a[i] = b[j] + (bench_urand() % 100 >= overlap &&
+		               (j+1 == nb || b[j+1] > b[j] + 1));
+	}
+}
+
+/* n is the size of both sets, b is ratio times larger than a */
+#define BENCH_SETS(name, ratio, overlap) \
+	BENCH_BEG(name) { \
+		size_t na = n / sizeof *a / (ratio + 1); \
+		gen_sets(na, na * ratio, overlap); \
+		TIME last = f(dst, a, na, b, na * ratio); \
+	} BENCH_END
+BENCH_SETS(1_sparse, 1, 10)
+BENCH_SETS(1_dense, 1, 90)
+BENCH_SETS(16, 16, 50)
+BENCH_SETS(256, 256, 50)
+
+Bench benches[] = {
+	BENCH( implsIntersect, MAX_MEM/2, "intersect 1:1 10% overlap", bench_1_sparse ),
+	BENCH( implsIntersect, MAX_MEM/2, "intersect 1:1 90% overlap", bench_1_dense ),
+	BENCH( implsIntersect, MAX_MEM/2, "intersect 1:16 50% overlap", bench_16 ),
+	BENCH( implsIntersect, MAX_MEM/2, "intersect 1:256 50% overlap", bench_256 ),
+	BENCH( implsUnion, MAX_MEM/2, "union 1:1 10% overlap", bench_1_sparse ),
+	BENCH( implsUnion, MAX_MEM/2, "union 1:1 90% overlap", bench_1_dense ),
+	BENCH( implsUnion, MAX_MEM/2, "union 1:16 50% overlap", bench_16 ),
+}; BENCH_MAIN(benches)
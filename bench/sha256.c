@@ -0,0 +1,147 @@
+#include "bench.h"
+
+uint32_t const sha256_k[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+#define ROR32(x,n) ((x) >> (n) | (x) << (32 - (n)))
+
+static uint32_t
+load_be32(uint8_t const *p)
+{
+	return (uint32_t)p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3];
+}
+
+static void
+store_be32(uint8_t *p, uint32_t x)
+{
+	p[0] = x >> 24; p[1] = x >> 16; p[2] = x >> 8; p[3] = x;
+}
+
+static void
+sha256_block(uint32_t s[8], uint8_t const *p)
+{
+	uint32_t w[64];
+	for (size_t i = 0; i < 16; ++i)
+		w[i] = load_be32(p + 4*i);
+	for (size_t i = 16; i < 64; ++i) {
+		uint32_t s0 = ROR32(w[i-15], 7) ^ ROR32(w[i-15], 18) ^ w[i-15] >> 3;
+		uint32_t s1 = ROR32(w[i-2], 17) ^ ROR32(w[i-2], 19) ^ w[i-2] >> 10;
+		w[i] = w[i-16] + s0 + w[i-7] + s1;
+	}
+	uint32_t a = s[0], b = s[1], c = s[2], d = s[3];
+	uint32_t e = s[4], f = s[5], g = s[6], h = s[7];
+	for (size_t i = 0; i < 64; ++i) {
+		uint32_t t1 = h + (ROR32(e, 6) ^ ROR32(e, 11) ^ ROR32(e, 25)) +
+		              ((e & f) ^ (~e & g)) + sha256_k[i] + w[i];
+		uint32_t t2 = (ROR32(a, 2) ^ ROR32(a, 13) ^ ROR32(a, 22)) +
+		              ((a & b) ^ (a & c) ^ (b & c));
+		h = g; g = f; f = e; e = d + t1;
+		d = c; c = b; b = a; a = t1 + t2;
+	}
+	s[0] += a; s[1] += b; s[2] += c; s[3] += d;
+	s[4] += e; s[5] += f; s[6] += g; s[7] += h;
+}
+
+/* Compresses nblocks 64 byte blocks of each of the nmsg messages at p,
+ * p + stride, ..., into the states s[0] to s[nmsg-1]. The multi-buffer
+ * impls require four byte aligned messages. */
+typedef void Func(uint32_t (*s)[8], uint8_t const *p, size_t stride, size_t nblocks, size_t nmsg);
+
+void
+sha256_scalar(uint32_t (*s)[8], uint8_t const *p, size_t stride, size_t nblocks, size_t nmsg)
+{
+	for (; nmsg--; ++s, p += stride)
+		for (size_t i = 0; i < nblocks; ++i)
+			sha256_block(*s, p + 64*i);
+}
+
+#if (__riscv_zvknha || __riscv_zvknhb) && (__riscv_zvkb || __riscv_zvbb)
+# define IMPLS_ZVKNH(f) f(rvv)
+# define IMPLS_ZVKNH_MB(f) f(rvv_mb_m1) f(rvv_mb_m2)
+#else
+# define IMPLS_ZVKNH(f)
+# define IMPLS_ZVKNH_MB(f)
+#endif
+
+#define IMPLS(f) \
+	f(scalar) \
+	IMPLS_ZVKNH(f) \
+
+/* one message per element group */
+#define IMPLS_MB(f) \
+	IMPLS(f) \
+	IMPLS_ZVKNH_MB(f) \
+
+#define DECLARE(f) extern Func sha256_##f;
+IMPLS_MB(DECLARE)
+
+#define EXTRACT(f) { #f, &sha256_##f, 0 },
+Impl impls[] = { IMPLS(EXTRACT) };
+Impl implsMb[] = { IMPLS_MB(EXTRACT) };
+
+#define MB_MSGS 16
+
+/* hashes nmsg messages of n bytes each into out, the padded last blocks
+ * are hashed in a second call */
+static void
+sha256(Func *f, uint8_t (*out)[32], uint8_t const *p, size_t stride, size_t n, size_t nmsg)
+{
+	static uint32_t s[MB_MSGS][8];
+	/* uint32_t for the alignment */
+	static uint32_t tail[MB_MSGS][32];
+	static uint32_t const iv[8] = {
+		0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+		0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+	};
+	size_t nb = n / 64, r = n % 64, tb = r < 56 ? 1 : 2;
+	for (size_t i = 0; i < nmsg; ++i) {
+		uint8_t *t = (uint8_t*)tail[i];
+		memcpy(s[i], iv, sizeof iv);
+		memcpy(t, p + i*stride + nb*64, r);
+		t[r] = 0x80;
+		memset(t + r + 1, 0, tb*64 - r - 9);
+		store_be32(t + tb*64 - 8, (uint64_t)n >> 29);
+		store_be32(t + tb*64 - 4, n << 3);
+	}
+	f(s, p, stride, nb, nmsg);
+	f(s, (uint8_t*)tail, sizeof *tail, tb, nmsg);
+	for (size_t i = 0; i < nmsg; ++i)
+		for (size_t j = 0; j < 8; ++j)
+			store_be32(out[i] + 4*j, s[i][j]);
+}
+
+static uint8_t digest[MB_MSGS][32];
+
+void init(void) { }
+
+ux checksum(size_t n) {
+	return bench_hash(0, digest, sizeof digest);
+}
+
+BENCH_BEG(single) {
+	TIME sha256(f, digest, mem, n, n, 1);
+} BENCH_END
+
+/* MB_MSGS independent messages of n bytes each, on separate cache lines */
+BENCH_BEG(multi) {
+	size_t stride = (n + 63) & -64;
+	TIME sha256(f, digest, mem, stride, n, MB_MSGS);
+} BENCH_END
+
+GUARD_BEG(single) {
+	sha256(f, digest, p, n, n, 1);
+	return checksum(n);
+} GUARD_END
+
+Bench benches[] = {
+	BENCH( impls, 1024*256, "sha256", bench_single, guard_single ),
+	BENCH( implsMb, 1024*16, "sha256 multi-buffer", bench_multi, .calls = MB_MSGS ),
+}; BENCH_MAIN(benches)
@@ -0,0 +1,214 @@
+#include "bench.h"
+
+/* The n elements of x are a single row. softmax and layernorm write it to
+ * dst, layernorm with the n gains at w, followed by the n biases. argmax
+ * and argmin return the index of the first largest or smallest element. */
+typedef size_t Func(float *dst, float const *x, float const *w, size_t n);
+
+#define LAYERNORM_EPS 1e-5f
+
+static inline uint32_t f32_bits(float f) { uint32_t u; memcpy(&u, &f, 4); return u; }
+static inline float f32_from(uint32_t u) { float f; memcpy(&f, &u, 4); return f; }
+
+/* exp(x) for x <= 0, within a few ulp down to the clamp at -87, so
+ * 2^k of the reduced argument stays a normal float. The vector impls use
+ * the same reduction and Taylor polynomial. */
+static inline float
+exp_neg(float x)
+{
+	x = x < -87 ? -87 : x;
+	float k = (x * 1.44269504f + 12582912.0f) - 12582912.0f;
+	float r = x - k * 0.693145751953125f - k * 1.42860677e-6f;
+	float p = 1 + r*(1 + r*(1/2.0f + r*(1/6.0f + r*(1/24.0f + r*(1/120.0f + r*(1/720.0f))))));
+	return f32_from(f32_bits(p) + ((uint32_t)(int32_t)k << 23));
+}
+
+static inline float
+sqrt_f32(float x)
+{
+	__asm__ ("fsqrt.s %0, %0\n" : "+f"(x));
+	return x;
+}
+
+size_t
+softmax_scalar(float *dst, float const *x, float const *w, size_t n)
+{
+	float max = -1.0f/0.0f, sum = 0;
+	for (size_t i = 0; i < n; ++i)
+		max = x[i] > max ? x[i] : max, BENCH_CLOBBER();
+	for (size_t i = 0; i < n; ++i)
+		sum += dst[i] = exp_neg(x[i] - max), BENCH_CLOBBER();
+	float inv = 1 / sum;
+	for (size_t i = 0; i < n; ++i)
+		dst[i] *= inv, BENCH_CLOBBER();
+	return 0;
+}
+
+size_t
+layernorm_scalar(float *dst, float const *x, float const *w, size_t n)
+{
+	float sum = 0, var = 0;
+	for (size_t i = 0; i < n; ++i)
+		sum += x[i], BENCH_CLOBBER();
+	float mean = sum / n;
+	for (size_t i = 0; i < n; ++i)
+		var += (x[i] - mean) * (x[i] - mean), BENCH_CLOBBER();
+	float rstd = 1 / sqrt_f32(var / n + LAYERNORM_EPS);
+	for (size_t i = 0; i < n; ++i)
+		dst[i] = (x[i] - mean) * rstd * w[i] + w[n+i], BENCH_CLOBBER();
+	return 0;
+}
+
+size_t
+argmax_scalar(float *dst, float const *x, float const *w, size_t n)
+{
+	size_t best = 0;
+	for (size_t i = 1; i < n; ++i)
+		best = x[i] > x[best] ? i : best, BENCH_CLOBBER();
+	return best;
+}
+
+size_t
+argmin_scalar(float *dst, float const *x, float const *w, size_t n)
+{
+	size_t best = 0;
+	for (size_t i = 1; i < n; ++i)
+		best = x[i] < x[best] ? i : best, BENCH_CLOBBER();
+	return best;
+}
+
+/* The sums of the vfadd impls accumulate in vector lanes, with a single
+ * vfredusum in the end, the others reduce every vector with vfredusum or
+ * the strictly ordered vfredosum. */
+#define IMPLS_SUM(f,T) \
+	f(T##_scalar) \
+	f(T##_rvv_vfadd_m1) \
+	f(T##_rvv_vfadd_m2) \
+	f(T##_rvv_vfadd_m4) \
+	f(T##_rvv_vfredusum_m1) \
+	f(T##_rvv_vfredusum_m2) \
+	f(T##_rvv_vfredusum_m4) \
+	f(T##_rvv_vfredosum_m1) \
+	f(T##_rvv_vfredosum_m2) \
+	f(T##_rvv_vfredosum_m4) \
+
+/* The twopass impls find the extremum, and then its first index, the
+ * onepass impls track the index of each lane's extremum. */
+#define IMPLS_ARG(f,T) \
+	f(T##_scalar) \
+	f(T##_rvv_twopass_m1) \
+	f(T##_rvv_twopass_m2) \
+	f(T##_rvv_twopass_m4) \
+	f(T##_rvv_onepass_m1) \
+	f(T##_rvv_onepass_m2) \
+	f(T##_rvv_onepass_m4) \
+
+#define DECLARE(f) extern Func f;
+IMPLS_SUM(DECLARE, softmax)
+IMPLS_SUM(DECLARE, layernorm)
+IMPLS_ARG(DECLARE, argmax)
+IMPLS_ARG(DECLARE, argmin)
+
+#define EXTRACT(f) { #f, &f, 0 },
+Impl implsSoftmax[] = { IMPLS_SUM(EXTRACT, softmax) };
+Impl implsLayernorm[] = { IMPLS_SUM(EXTRACT, layernorm) };
+Impl implsArgmax[] = { IMPLS_ARG(EXTRACT, argmax) };
+Impl implsArgmin[] = { IMPLS_ARG(EXTRACT, argmin) };
+
+#define MAX_ROW (1024*64)
+
+static float *dst, *logits, *act, *weights, *wbuf;
+static size_t last, lastIdx;
+static enum { SOFTMAX, LAYERNORM, ARG } lastKind;
+
+void init(void) {
+	dst = (float*)mem;
+	logits = dst + MAX_ROW;
+	act = logits + MAX_ROW;
+	weights = act + MAX_ROW;
+	wbuf = weights + 2*MAX_ROW;
+	for (size_t i = 0; i < MAX_ROW; ++i) {
+		logits[i] = (bench_urandf() - 0.5f) * 20;
+		act[i] = bench_urandf() * 8 + 3;
+		weights[i] = bench_urandf() + 0.5f;
+		weights[MAX_ROW+i] = bench_urandf() - 0.5f;
+	}
+}
+
+/* exp in double precision, for |x| < 700 */
+static double
+ref_exp(double x)
+{
+	double k = (int64_t)(x * 1.4426950408889634 + (x < 0 ? -0.5 : 0.5));
+	double r = x - k * 0.6931471805599453, p = 1, t = 1;
+	for (int i = 1; i < 14; ++i)
+		p += t *= r / i;
+	uint64_t u = (uint64_t)(1023 + (int64_t)k) << 52;
+	double s;
+	memcpy(&s, &u, 8);
+	return p * s;
+}
+
+/* The float results depend on the order of the additions, so they are
+ * compared to a double precision reference, and the checksum counts the
+ * elements outside of the tolerance, which is zero for every good impl. */
+ux checksum(size_t n) {
+	ux bad = 0;
+	double max = -1.0/0.0, sum = 0, var = 0, mean, rstd;
+	switch (lastKind) {
+	case SOFTMAX:
+		for (size_t i = 0; i < last; ++i)
+			max = logits[i] > max ? logits[i] : max;
+		for (size_t i = 0; i < last; ++i)
+			sum += ref_exp(logits[i] - max);
+		for (size_t i = 0; i < last; ++i) {
+			double y = ref_exp(logits[i] - max) / sum;
+			bad += !(dst[i] >= y - y*1e-3 - 1e-30 && dst[i] <= y + y*1e-3 + 1e-30);
+		}
+		return bad;
+	case LAYERNORM:
+		for (size_t i = 0; i < last; ++i)
+			sum += act[i];
+		mean = sum / last;
+		for (size_t i = 0; i < last; ++i)
+			var += (act[i] - mean) * (act[i] - mean);
+		rstd = 1 / sqrt_f32(var / last + LAYERNORM_EPS);
+		for (size_t i = 0; i < last; ++i) {
+			double y = (act[i] - mean) * rstd * weights[i] + weights[MAX_ROW+i];
+			double tol = ((y < 0 ? -y : y) + 1) * 1e-3;
+			bad += !(dst[i] >= y - tol && dst[i] <= y + tol);
+		}
+		return bad;
+	case ARG:
+		return lastIdx;
+	}
+	return 0;
+}
+
+BENCH_BEG(softmax) {
+	n /= sizeof(float);
+	last = n, lastKind = SOFTMAX;
+	TIME f(dst, logits, 0, n);
+} BENCH_END
+
+/* the gains and biases aren't counted in the size */
+BENCH_BEG(layernorm) {
+	n /= sizeof(float);
+	last = n, lastKind = LAYERNORM;
+	memcpy(wbuf, weights, n * sizeof(float));
+	memcpy(wbuf + n, weights + MAX_ROW, n * sizeof(float));
+	TIME f(dst, act, wbuf, n);
+} BENCH_END
+
+BENCH_BEG(arg) {
+	n /= sizeof(float);
+	lastKind = ARG;
+	TIME lastIdx = f(0, logits, 0, n);
+} BENCH_END
+
+Bench benches[] = {
+	BENCH( implsSoftmax, MAX_ROW*sizeof(float), "softmax f32", bench_softmax ),
+	BENCH( implsLayernorm, MAX_ROW*sizeof(float), "layernorm f32", bench_layernorm ),
+	BENCH( implsArgmax, MAX_ROW*sizeof(float), "argmax f32", bench_arg ),
+	BENCH( implsArgmin, MAX_ROW*sizeof(float), "argmin f32", bench_arg ),
+}; BENCH_MAIN(benches)
@@ -0,0 +1,343 @@
+#include "bench.h"
+
+/* KV is a uint32_t value in the low half of a uint64_t, and the uint32_t
+ * key in the high half, so the pairs sort like U64, and the equal keys
+ * keep the order of the values, which start as the input positions. */
+enum { U32, U64, F32, KV };
+
+/* sorts the n elements at p, tmp is scratch space of the same size */
+typedef void Func(void *p, void *tmp, size_t n, int type);
+
+static size_t
+type_size(int type)
+{
+	return type == U32 || type == F32 ? 4 : 8;
+}
+
+static int
+compare_u32(void const *a, void const *b)
+{
+	uint32_t x = *(uint32_t const*)a, y = *(uint32_t const*)b;
+	return (x > y) - (x < y);
+}
+
+static int
+compare_u64(void const *a, void const *b)
+{
+	uint64_t x = *(uint64_t const*)a, y = *(uint64_t const*)b;
+	return (x > y) - (x < y);
+}
+
+static int
+compare_f32(void const *a, void const *b)
+{
+	float x = *(float const*)a, y = *(float const*)b;
+	return (x > y) - (x < y);
+}
+
+static int (*const compare[])(void const*, void const*) = {
+	[U32] = compare_u32, [U64] = compare_u64,
+	[F32] = compare_f32, [KV] = compare_u64,
+};
+
+static uint64_t
+key_at(void const *p, size_t i, size_t w)
+{
+	return w == 4 ? ((uint32_t const*)p)[i] : ((uint64_t const*)p)[i];
+}
+
+static void
+key_set(void *p, size_t i, size_t w, uint64_t k)
+{
+	if (w == 4) ((uint32_t*)p)[i] = k;
+	else        ((uint64_t*)p)[i] = k;
+}
+
+/* maps floats to uint32_t keys of the same order, and back */
+static void
+f32_to_key(uint32_t *p, size_t n)
+{
+	for (size_t i = 0; i < n; ++i)
+		p[i] ^= -(p[i] >> 31) | 0x80000000;
+}
+
+static void
+key_to_f32(uint32_t *p, size_t n)
+{
+	for (size_t i = 0; i < n; ++i)
+		p[i] ^= ((p[i] >> 31) - 1) | 0x80000000;
+}
+
+/* the key bytes lo to hi-1 of the type, always an even number of passes */
+static void
+radix_bytes(int type, size_t *lo, size_t *hi)
+{
+	*lo = type == KV ? 4 : 0;
+	*hi = type == U64 ? 8 : *lo + 4;
+}
+
+void
+sort_qsort(void *p, void *tmp, size_t n, int type)
+{
+	qsort(p, n, type_size(type), compare[type]);
+}
+
+/* LSD radix sort with 8-bit digits, counting every digit up front */
+void
+sort_radix_scalar(void *p, void *tmp, size_t n, int type)
+{
+	static uint32_t cnt[8][256];
+	size_t w = type_size(type), lo, hi;
+	radix_bytes(type, &lo, &hi);
+	if (type == F32) f32_to_key(p, n);
+	memset(cnt, 0, sizeof cnt);
+	for (size_t i = 0; i < n; ++i) {
+		uint64_t k = key_at(p, i, w);
+		for (size_t b = lo; b < hi; ++b)
+			++cnt[b][k >> 8*b & 255];
+	}
+	for (size_t b = lo; b < hi; ++b) {
+		uint32_t sum = 0;
+		for (size_t d = 0; d < 256; ++d) {
+			uint32_t c = cnt[b][d];
+			cnt[b][d] = sum;
+			sum += c;
+		}
+		for (size_t i = 0; i < n; ++i) {
+			uint64_t k = key_at(p, i, w);
+			key_set(tmp, cnt[b][k >> 8*b & 255]++, w, k);
+		}
+		void *t = p; p = tmp; tmp = t;
+	}
+	if (type == F32) key_to_f32(p, n);
+}
+
+/* Returns the lanes, and sets cnt[digit*(lanes+1) + lane] to the count of
+ * the digits in each lane's chunk, and zero for the extra slot. */
+typedef size_t Count(uint32_t *cnt, void const *src, size_t n, size_t shift);
+/* scatters src to dst, with off holding the exclusive prefix sum */
+typedef void Scatter(void *dst, void const *src, size_t n, size_t shift, uint32_t *off);
+
+#define RADIX_LANES 64
+
+/* The vector kernels split the elements into a chunk per lane, and leave
+ * the n % lanes elements at the end to this function, which counts and
+ * scatters them in the extra slot of every digit. */
+static void
+radix_rvv(Count *count, Scatter *scatter, void *p, void *tmp, size_t n, int type)
+{
+	static uint32_t cnt[256 * (RADIX_LANES + 1)];
+	size_t w = type_size(type), lo, hi;
+	radix_bytes(type, &lo, &hi);
+	if (type == F32) f32_to_key(p, n);
+	for (size_t b = lo; b < hi; ++b) {
+		size_t shift = 8*b, lanes = count(cnt, p, n, shift);
+		size_t rows = lanes + 1, tail = n / lanes * lanes;
+		for (size_t i = tail; i < n; ++i)
+			++cnt[(key_at(p, i, w) >> shift & 255) * rows + lanes];
+		uint32_t sum = 0;
+		for (size_t i = 0; i < 256 * rows; ++i) {
+			uint32_t c = cnt[i];
+			cnt[i] = sum;
+			sum += c;
+		}
+		scatter(tmp, p, n, shift, cnt);
+		for (size_t i = tail; i < n; ++i) {
+			uint64_t k = key_at(p, i, w);
+			key_set(tmp, cnt[(k >> shift & 255) * rows + lanes]++, w, k);
+		}
+		void *t = p; p = tmp; tmp = t;
+	}
+	if (type == F32) key_to_f32(p, n);
+}
+
+/* the 64-bit kernels need Zve64, and are only listed for the 64-bit types */
+#define RADIX_RVV(lmul) \
+	extern Count radix_count32_rvv_##lmul; \
+	extern Scatter radix_scatter32_rvv_##lmul; \
+	IF_VE64(extern Count radix_count64_rvv_##lmul;) \
+	IF_VE64(extern Scatter radix_scatter64_rvv_##lmul;) \
+	void sort_radix_rvv_##lmul(void *p, void *tmp, size_t n, int type) { \
+		if (type_size(type) == 4) \
+			radix_rvv(radix_count32_rvv_##lmul, radix_scatter32_rvv_##lmul, p, tmp, n, type); \
+		IF_VE64(else \
+			radix_rvv(radix_count64_rvv_##lmul, radix_scatter64_rvv_##lmul, p, tmp, n, type);) \
+	}
+RADIX_RVV(m1)
+RADIX_RVV(m2)
+RADIX_RVV(m4)
+
+#define IMPLS_RADIX_RVV(f) \
+	f(radix_rvv_m1) \
+	f(radix_rvv_m2) \
+	f(radix_rvv_m4) \
+
+#define IMPLS(f) \
+	f(qsort) \
+	f(radix_scalar) \
+	IMPLS_RADIX_RVV(f) \
+
+#define IMPLS64(f) \
+	f(qsort) \
+	f(radix_scalar) \
+	IF_VE64(IMPLS_RADIX_RVV(f)) \
+
+#define EXTRACT(f) { #f, &sort_##f, 0 },
+Impl impls[] = { IMPLS(EXTRACT) };
+Impl impls64[] = { IMPLS64(EXTRACT) };
+
+/* The small array benchmarks sort every block of NET_BLOCK elements on its
+ * own, which the sorting networks do in registers. */
+#define NET_BLOCK 16
+
+typedef void Net(void *p, size_t n, size_t block);
+
+void
+sort_net_qsort(void *p, void *tmp, size_t n, int type)
+{
+	size_t w = type_size(type);
+	for (size_t i = 0; i < n; i += NET_BLOCK)
+		qsort((char*)p + i*w, NET_BLOCK, w, compare[type]);
+}
+
+void
+sort_net_insertion(void *p, void *tmp, size_t n, int type)
+{
+	size_t w = type_size(type);
+	for (uint8_t *b = p, *e = b + n*w; b != e; b += NET_BLOCK*w) {
+		for (size_t i = 1; i < NET_BLOCK; ++i) {
+			uint64_t k = key_at(b, i, w);
+			size_t j = i;
+			if (type == F32) {
+				float f;
+				memcpy(&f, &k, 4);
+				for (; j > 0; --j) {
+					uint64_t x = key_at(b, j-1, w);
+					float g;
+					memcpy(&g, &x, 4);
+					if (g <= f) break;
+					key_set(b, j, w, x);
+				}
+			} else {
+				for (; j > 0 && key_at(b, j-1, w) > k; --j)
+					key_set(b, j, w, key_at(b, j-1, w));
+			}
+			key_set(b, j, w, k);
+		}
+	}
+}
+
+/* 64-bit keys always take LMUL=8, and need Zve64 */
+IF_VE64(extern Net sortnet_u64_rvv_m8;)
+#define SORTNET_RVV(lmul) \
+	extern Net sortnet_u32_rvv_##lmul, sortnet_f32_rvv_##lmul; \
+	void sort_net_rvv_##lmul(void *p, void *tmp, size_t n, int type) { \
+		Net *net = type == U32 ? sortnet_u32_rvv_##lmul : \
+		           IF_VE64(type != F32 ? sortnet_u64_rvv_m8 :) \
+		           sortnet_f32_rvv_##lmul; \
+		net(p, n, NET_BLOCK); \
+	}
+SORTNET_RVV(m4)
+SORTNET_RVV(m8)
+
+#define IMPLS_NET32(f) \
+	f(net_qsort) \
+	f(net_insertion) \
+	f(net_rvv_m4) \
+	f(net_rvv_m8) \
+
+#define IMPLS_NET64(f) \
+	f(net_qsort) \
+	f(net_insertion) \
+	IF_VE64(f(net_rvv_m8)) \
+
+Impl implsNet32[] = { IMPLS_NET32(EXTRACT) };
+Impl implsNet64[] = { IMPLS_NET64(EXTRACT) };
+
+#define N_F32 (1024*1024)
+
+static uint8_t *buf, *scratch, *input;
+static size_t last;
+
+void init(void) {
+	buf = mem;
+	scratch = mem + MAX_MEM/4;
+	input = mem + MAX_MEM/2;
+	/* finite floats of both signs, after the random integer keys */
+	float *f = (float*)(input + MAX_MEM/4);
+	for (size_t i = 0; i < N_F32/4; ++i)
+		f[i] = (bench_urandf() - 0.5f) * 1000;
+}
+
+ux checksum(size_t n) {
+	return bench_hash(0, buf, last);
+}
+
+/* copies the input of n bytes, and returns the number of elements */
+static size_t
+prepare(int type, size_t n, size_t multiple)
+{
+	size_t w = type_size(type);
+	n = n / w / multiple * multiple;
+	last = n * w;
+	if (type == KV) {
+		uint64_t *p = (uint64_t*)buf;
+		uint32_t const *k = (uint32_t const*)input;
+		for (size_t i = 0; i < n; ++i)
+			p[i] = (uint64_t)k[i] << 32 | i;
+	} else {
+		memcpy(buf, type == F32 ? input + MAX_MEM/4 : input, last);
+	}
+	return n;
+}
+
+BENCH_BEG(u32) {
+	n = prepare(U32, n, 1);
+	TIME f(buf, scratch, n, U32);
+} BENCH_END
+
+BENCH_BEG(u64) {
+	n = prepare(U64, n, 1);
+	TIME f(buf, scratch, n, U64);
+} BENCH_END
+
+BENCH_BEG(f32) {
+	n = prepare(F32, n, 1);
+	TIME f(buf, scratch, n, F32);
+} BENCH_END
+
+BENCH_BEG(kv) {
+	n = prepare(KV, n, 1);
+	TIME f(buf, scratch, n, KV);
+} BENCH_END
+
+BENCH_BEG(net_u32) {
+	n = prepare(U32, n, NET_BLOCK);
+	TIME f(buf, scratch, n, U32);
+} BENCH_END
+
+BENCH_BEG(net_u64) {
+	n = prepare(U64, n, NET_BLOCK);
+	TIME f(buf, scratch, n, U64);
+} BENCH_END
+
+BENCH_BEG(net_f32) {
+	n = prepare(F32, n, NET_BLOCK);
+	TIME f(buf, scratch, n, F32);
+} BENCH_END
+
+BENCH_BEG(net_kv) {
+	n = prepare(KV, n, NET_BLOCK);
+	TIME f(buf, scratch, n, KV);
+} BENCH_END
+
+Bench benches[] = {
+	BENCH( impls, 1024*1024, "sort u32", bench_u32 ),
+	BENCH( impls64, 1024*1024, "sort u64", bench_u64 ),
+	BENCH( impls, N_F32, "sort f32", bench_f32 ),
+	BENCH( impls64, 1024*1024, "sort u32 key-value pairs", bench_kv ),
+	BENCH( implsNet32, 1024*64, "sort u32 blocks of 16", bench_net_u32 ),
+	BENCH( implsNet64, 1024*64, "sort u64 blocks of 16", bench_net_u64 ),
+	BENCH( implsNet32, 1024*64, "sort f32 blocks of 16", bench_net_f32 ),
+	BENCH( implsNet64, 1024*64, "sort u32 key-value pair blocks of 16", bench_net_kv ),
+}; BENCH_MAIN(benches)
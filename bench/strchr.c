@@ -0,0 +1,115 @@
+#include "bench.h"
+
+char *
+strchr_scalar(char const *s, int c)
+{
+	for (; *s != (char)c; ++s, BENCH_CLOBBER())
+		if (!*s) return 0;
+	return (char*)s;
+}
+
+char *
+strchr_scalar_autovec(char const *s, int c)
+{
+	for (; *s != (char)c; ++s)
+		if (!*s) return 0;
+	return (char*)s;
+}
+
+/* https://git.musl-libc.org/cgit/musl/tree/src/string/strchrnul.c */
+#define ALIGN (sizeof(size_t))
+#define ONES ((size_t)-1/UCHAR_MAX)
+#define HIGHS (ONES * (UCHAR_MAX/2+1))
+#define HASZERO(x) (((x)-ONES) & ~(x) & HIGHS)
+static char *
+strchrnul_musl(char const *s, int c)
+{
+	c = (unsigned char)c;
+	if (!c) return (char *)s + strlen(s);
+
+#ifdef __GNUC__
+	typedef size_t __attribute__((__may_alias__)) word;
+	word const *w;
+	for (; (uintptr_t)s % ALIGN; s++)
+		if (!*s || *(unsigned char *)s == c) return (char *)s;
+	size_t k = ONES * c;
+	for (w = (void const*)s; !HASZERO(*w) && !HASZERO(*w^k); w++);
+	s = (void const*)w;
+#endif
+	for (; *s && *(unsigned char *)s != c; s++);
+	return (char *)s;
+}
+
+/* https://git.musl-libc.org/cgit/musl/tree/src/string/strchr.c */
+char *
+strchr_musl(char const *s, int c)
+{
+	char *r = strchrnul_musl(s, c);
+	return *(unsigned char *)r == (unsigned char)c ? r : 0;
+}
+
+#define strchr_libc strchr
+
+#define IMPLS(f) \
+	f(scalar) \
+	f(scalar_autovec) \
+	IFHOSTED(f(libc)) \
+	f(musl) \
+	MX(f, rvv_page_aligned) \
+	MX(f, rvv) \
+
+typedef char *Func(char const *s, int c);
+
+#define DECLARE(f) extern Func strchr_##f;
+IMPLS(DECLARE)
+
+#define EXTRACT(f) { #f, &strchr_##f, 0 },
+Impl impls[] = { IMPLS(EXTRACT) };
+
+ux last;
+char c, fill; /* fill is neither c nor null */
+
+void init(void) {
+	do c = bench_urand(); while (!c);
+	fill = c == 1 ? 2 : 1;
+	for (size_t i = 0; i < MAX_MEM; ++i)
+		while (!mem[i] || mem[i] == (unsigned char)c)
+			++mem[i]; // remove null bytes and c
+}
+
+ux checksum(size_t n) { return last; }
+
+/* no match, search until the null terminator */
+BENCH_BEG(base) {
+	char *p = (char*)mem + (bench_urand() % 511), *r;
+	p[n] = 0;
+	TIME r = f(p, c);
+	last = r ? r - p : -1;
+	p[n] = fill;
+} BENCH_END
+
+/* match at a uniformly random position */
+BENCH_BEG(random) {
+	char *p = (char*)mem + (bench_urand() % 511), *r;
+	size_t pos = bench_urand() % n;
+	p[n] = 0;
+	p[pos] = c;
+	TIME r = f(p, c);
+	last = r ? r - p : -1;
+	p[n] = p[pos] = fill;
+} BENCH_END
+
+GUARD_BEG(base) {
+	if (!n) return 0;
+	for (size_t i = 0; i < n; ++i)
+		p[i] += !p[i];
+	p[n-1] = 0;
+	char *r = f((char*)p, p[n/2]);
+	return r ? r - (char*)p : -1;
+} GUARD_END
+
+Bench benches[] = {
+	BENCH( impls, MAX_MEM - 521, "strchr", bench_base, guard_base ),
+	BENCH( impls, MAX_MEM - 521, "strchr random match", bench_random ),
+}; BENCH_MAIN(benches)
+
@@ -0,0 +1,89 @@
+#include "bench.h"
+
+int
+strcmp_scalar(char const *l, char const *r)
+{
+	for (; *l==*r && *l; l++, r++) BENCH_CLOBBER();
+	return *(unsigned char *)l - *(unsigned char *)r;
+}
+
+/* https://git.musl-libc.org/cgit/musl/tree/src/string/strcmp.c */
+int
+strcmp_musl(char const *l, char const *r)
+{
+	for (; *l==*r && *l; l++, r++);
+	return *(unsigned char *)l - *(unsigned char *)r;
+}
+
+#define strcmp_libc strcmp
+
+#define IMPLS(f) \
+	f(scalar) \
+	IFHOSTED(f(libc)) \
+	f(musl) \
+	MX(f, rvv_page_aligned) \
+	MX(f, rvv) \
+
+typedef int Func(char const *l, char const *r);
+
+#define DECLARE(f) extern Func strcmp_##f;
+IMPLS(DECLARE)
+
+#define EXTRACT(f) { #f, &strcmp_##f, 0 },
+Impl impls[] = { IMPLS(EXTRACT) };
+
+char *a, *b;
+ux last;
+
+void init(void) {
+	for (size_t i = 0; i < MAX_MEM; ++i)
+		mem[i] += !mem[i]; // remove null bytes
+}
+
+/* only the sign is specified */
+ux checksum(size_t n) { return (int)last < 0 ? -1 : (int)last > 0; }
+
+/* the inputs have independent alignments, so they cross pages at
+ * different offsets */
+void common(size_t n) {
+	a = (char*)mem + (bench_urand() % 511);
+	b = (char*)mem + MAX_MEM/2 + (bench_urand() % 511);
+	memcpy(b, a, n);
+	a[n] = b[n] = 0;
+}
+
+void restore(size_t n) {
+	a[n] = b[n] = 1;
+}
+
+/* equal strings, compared up to the null terminator */
+BENCH_BEG(base) {
+	common(n);
+	TIME last = f(a, b);
+	restore(n);
+} BENCH_END
+
+/* mismatch at a uniformly random position */
+BENCH_BEG(random) {
+	common(n);
+	size_t pos = bench_urand() % n;
+	b[pos] = (unsigned char)a[pos] % 255 + 1;
+	TIME last = f(a, b);
+	restore(n);
+} BENCH_END
+
+GUARD_BEG(base) {
+	if (!n) return 0;
+	for (size_t i = 0; i < n; ++i)
+		p[i] += !p[i];
+	p[n-1] = 0;
+	memcpy(mem, p, n);
+	int r = f((char*)p, (char*)mem);
+	return r < 0 ? -1 : r > 0;
+} GUARD_END
+
+Bench benches[] = {
+	BENCH( impls, MAX_MEM/2 - 521, "strcmp", bench_base, guard_base ),
+	BENCH( impls, MAX_MEM/2 - 521, "strcmp random mismatch", bench_random ),
+}; BENCH_MAIN(benches)
+
@@ -70,7 +70,50 @@ BENCH_BEG(base) {
 	p[n] = bench_urand() | 1;
 } BENCH_END
 
+/* the next string starts at an offset of the previous result minus n */
+BENCH_BEG(latency) {
+	char *p = (char*)mem + (bench_urand() % 511);
+	size_t len = n;
+	p[n] = 0;
+	TIME for (size_t k = 0; k < CHAIN_CALLS; ++k)
+		len = f(p + len - n);
+	last = len;
+	p[n] = bench_urand() | 1;
+} BENCH_END
+
+BENCH_BEG(throughput) {
+	char *p = (char*)mem + (bench_urand() % 511);
+	for (size_t k = 0; k < CHAIN_CALLS; ++k)
+		p[k*(n+1) + n] = 0;
+	last = 0;
+	TIME for (size_t k = 0; k < CHAIN_CALLS; ++k)
+		last += f(p + k*(n+1));
+	for (size_t k = 0; k < CHAIN_CALLS; ++k)
+		p[k*(n+1) + n] = bench_urand() | 1;
+} BENCH_END
+
+GUARD_BEG(base) {
+	if (!n) return 0;
+	for (size_t i = 0; i < n; ++i)
+		p[i] += !p[i];
+	p[n-1] = 0;
+	return f((char*)p);
+} GUARD_END
+
+REPLAY_BEG(base) {
+	char *p = (char*)mem + MAX_MEM/2;
+	for (ReplayCall const *c = calls; c != calls + nCalls; ++c)
+		p[c->sOff + c->n] = 0;
+	replayResult = 0;
+	TIME for (ReplayCall const *c = calls; c != calls + nCalls; ++c)
+		replayResult += f(p + c->sOff);
+	for (ReplayCall const *c = calls; c != calls + nCalls; ++c)
+		p[c->sOff + c->n] = bench_urand() | 1;
+} REPLAY_END
+
 Bench benches[] = {
-	BENCH( impls, MAX_MEM - 521, "strlen", bench_base ),
+	BENCH( impls, MAX_MEM - 521, "strlen", bench_base, guard_base, replay_base ),
+	BENCH( impls, 1024, "strlen latency", bench_latency, .calls = CHAIN_CALLS ),
+	BENCH( impls, 1024, "strlen throughput", bench_throughput, .calls = CHAIN_CALLS ),
 }; BENCH_MAIN(benches)
 
@@ -0,0 +1,229 @@
+#include "bench.h"
+
+/* Lookups in an open addressing hash table of 64-bit keys, with a control
+ * byte per slot, like abseil's SwissTable. The control byte of a full slot
+ * is the low 7 bits of the hash (H2), and CTRL_EMPTY for an empty one. A
+ * lookup starts at the group of slots given by the other hash bits (H1),
+ * matches H2 against the whole group at once, and compares the keys of
+ * the matches. It misses once a group has an empty slot, otherwise it
+ * continues with triangular probing over the groups. Unlike abseil, the
+ * groups are aligned, so the group loads are aligned as well. */
+
+#define CTRL_EMPTY 0x80
+/* 512K of keys and 64K of control bytes, at most 7/8 full */
+#define SLOTS (1u << 16)
+
+typedef struct {
+	/* read by the rvv impls */
+	uint8_t *ctrl;
+	uint64_t *slots;
+	size_t mask, group;
+	/* the inserted keys, for the hits */
+	uint64_t *keys;
+	size_t count;
+} Table;
+
+/* returns the sum of the found slots plus one, which is 0 for a miss */
+typedef size_t Func(Table const *t, uint64_t const *keys, size_t n);
+
+/* splitmix64 finalizer */
+static inline uint64_t
+swiss_hash(uint64_t x)
+{
+	x ^= x >> 30, x *= 0xbf58476d1ce4e5b9u;
+	x ^= x >> 27, x *= 0x94d049bb133111ebu;
+	return x ^ x >> 31;
+}
+
+static inline size_t
+swiss_start(Table const *t, uint64_t h)
+{
+	return (h >> 7) & t->mask & -t->group;
+}
+
+size_t
+swiss_scalar(Table const *t, uint64_t const *keys, size_t n)
+{
+	size_t sum = 0;
+	for (size_t k = 0; k < n; ++k) {
+		uint64_t key = keys[k], h = swiss_hash(key);
+		size_t pos = swiss_start(t, h), step = 0;
+		for (;;) {
+			uint8_t const *g = t->ctrl + pos;
+			int empty = 0;
+			for (size_t i = 0; i < t->group; ++i) {
+				if (g[i] == (h & 0x7f) && t->slots[pos+i] == key) {
+					sum += pos + i + 1;
+					goto next;
+				}
+				empty |= g[i] == CTRL_EMPTY, BENCH_CLOBBER();
+			}
+			if (empty)
+				break;
+			step += t->group;
+			pos = (pos + step) & t->mask;
+		}
+	next:;
+	}
+	return sum;
+}
+
+/* Matches a word of control bytes at once. The matches of H2 may have false
+ * positives above a true match, which fail the key compare, and only the
+ * empty control bytes have the top bit set. */
+#define GEN_SWAR(name, first) \
+	size_t \
+	swiss_##name(Table const *t, uint64_t const *keys, size_t n) \
+	{ \
+		ux const lo = -(ux)1/255, hi = lo << 7; \
+		size_t sum = 0; \
+		for (size_t k = 0; k < n; ++k) { \
+			uint64_t key = keys[k], h = swiss_hash(key); \
+			size_t pos = swiss_start(t, h), step = 0; \
+			ux h2 = (h & 0x7f) * lo; \
+			for (;;) { \
+				ux const BENCH_MAY_ALIAS *g = (ux const*)(t->ctrl + pos); \
+				ux empty = 0; \
+				for (size_t w = 0; w < t->group / sizeof *g; ++w) { \
+					ux x = g[w] ^ h2; \
+					ux m = (x - lo) & ~x & hi; \
+					for (size_t i; m; m &= m - 1) { \
+						i = pos + w*sizeof *g + first(m) / 8; \
+						if (t->slots[i] == key) { \
+							sum += i + 1; \
+							goto next; \
+						} \
+					} \
+					empty |= g[w] & hi; \
+				} \
+				if (empty) \
+					break; \
+				step += t->group; \
+				pos = (pos + step) & t->mask; \
+			} \
+		next:; \
+		} \
+		return sum; \
+	}
+
+/* index of the lowest set bit */
+static inline size_t
+ufirst(ux x)
+{
+	size_t i = 0;
+	for (; !(x & 1); x >>= 1)
+		++i;
+	return i;
+}
+
+GEN_SWAR(SWAR, ufirst)
+#if __riscv_zbb
+GEN_SWAR(SWAR_ctz, __builtin_ctzll)
+# define CTZ(f) f(SWAR_ctz)
+#else
+# define CTZ(f)
+#endif
+
+/* The rvv impls match the group with vmseq, iterate over the matches with
+ * vfirst and check for empty slots with vcpop, a group larger than the
+ * vector is matched in parts. They read the Table with rv64 offsets. */
+#define IMPLS(f) \
+	f(scalar) \
+	f(SWAR) \
+	CTZ(f) \
+	IF64(f(rvv_mf2)) \
+	IF64(f(rvv_m1)) \
+
+#define DECLARE(f) extern Func swiss_##f;
+IMPLS(DECLARE)
+
+#define EXTRACT(f) { #f, &swiss_##f, 0 },
+Impl impls[] = { IMPLS(EXTRACT) };
+
+static uint8_t ctrl[3][SLOTS];
+static uint64_t slots[3][SLOTS], inserted[3][SLOTS];
+static Table g16half, g16full, gvlen;
+static size_t last;
+
+static uint64_t
+rand64(void)
+{
+	return (uint64_t)bench_urand() << 32 ^ bench_urand();
+}
+
+static size_t
+vlenb(void)
+{
+	size_t x;
+	__asm__ ("csrr %0, vlenb\n" : "=r"(x));
+	return x;
+}
+
+static void
+table_init(Table *t, size_t idx, size_t group, size_t count)
+{
+	t->ctrl = ctrl[idx], t->slots = slots[idx], t->keys = inserted[idx];
+	t->mask = SLOTS - 1, t->group = group, t->count = count;
+	memset(t->ctrl, CTRL_EMPTY, SLOTS);
+	for (size_t k = 0; k < count; ++k) {
+		uint64_t key = rand64(), h = swiss_hash(key);
+		if (swiss_scalar(t, &key, 1)) {
+			--k;
+			continue;
+		}
+		size_t pos = swiss_start(t, h), step = 0;
+		for (;;) {
+			size_t i = 0;
+			while (i < group && t->ctrl[pos+i] != CTRL_EMPTY)
+				++i;
+			if (i < group) {
+				pos += i;
+				break;
+			}
+			step += group;
+			pos = (pos + step) & t->mask;
+		}
+		t->ctrl[pos] = h & 0x7f;
+		t->slots[pos] = t->keys[k] = key;
+	}
+}
+
+void init(void) {
+	size_t vg = vlenb();
+	table_init(&g16half, 0, 16, SLOTS/2);
+	table_init(&g16full, 1, 16, SLOTS/8*7);
+	table_init(&gvlen, 2, vg < SLOTS ? vg : SLOTS, SLOTS/8*7);
+}
+
+ux checksum(size_t n) { return last; }
+
+/* n is the size of the looked up keys, hit percent of them are in the
+ * table, the others almost certainly aren't */
+#define BENCH_PROBE(name, tab, hit) \
+	BENCH_BEG(name) { \
+		uint64_t *k = (uint64_t*)mem; \
+		n /= sizeof *k; \
+		for (size_t i = 0; i < n; ++i) \
+			k[i] = (int)(bench_urand() % 100) < hit ? \
+			       tab.keys[bench_urand() % tab.count] : rand64(); \
+		TIME last = f(&tab, k, n); \
+	} BENCH_END
+BENCH_PROBE(half_hit, g16half, 100)
+BENCH_PROBE(half_miss, g16half, 0)
+BENCH_PROBE(full_hit, g16full, 100)
+BENCH_PROBE(full_miss, g16full, 0)
+BENCH_PROBE(full_mixed, g16full, 50)
+BENCH_PROBE(vlen_hit, gvlen, 100)
+BENCH_PROBE(vlen_miss, gvlen, 0)
+BENCH_PROBE(vlen_mixed, gvlen, 50)
+
+Bench benches[] = {
+	BENCH( impls, MAX_MEM/16, "swisstable group16 load 1/2 hit", bench_half_hit ),
+	BENCH( impls, MAX_MEM/16, "swisstable group16 load 1/2 miss", bench_half_miss ),
+	BENCH( impls, MAX_MEM/16, "swisstable group16 load 7/8 hit", bench_full_hit ),
+	BENCH( impls, MAX_MEM/16, "swisstable group16 load 7/8 miss", bench_full_miss ),
+	BENCH( impls, MAX_MEM/16, "swisstable group16 load 7/8 half hit", bench_full_mixed ),
+	BENCH( impls, MAX_MEM/16, "swisstable groupVLEN load 7/8 hit", bench_vlen_hit ),
+	BENCH( impls, MAX_MEM/16, "swisstable groupVLEN load 7/8 miss", bench_vlen_miss ),
+	BENCH( impls, MAX_MEM/16, "swisstable groupVLEN load 7/8 half hit", bench_vlen_mixed ),
+}; BENCH_MAIN(benches)
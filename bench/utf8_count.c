@@ -128,9 +128,32 @@ BENCH_BEG(aligned) {
 	TIME last = (uintptr_t)f(str, n);
 } BENCH_END
 
+/* the input of the next call is offset by the previous result minus the
+ * result of an untimed first call, which is always zero */
+BENCH_BEG(latency) {
+	common(n, bench_urand() & 511);
+	size_t first = f(str, n), count = first;
+	TIME for (size_t k = 0; k < CHAIN_CALLS; ++k)
+		count = f(str + count - first, n);
+	last = count;
+} BENCH_END
+
+BENCH_BEG(throughput) {
+	common(n * CHAIN_CALLS, bench_urand() & 511);
+	last = 0;
+	TIME for (size_t k = 0; k < CHAIN_CALLS; ++k)
+		last += f(str + k*n, n);
+} BENCH_END
+
+GUARD_BEG(base) {
+	return f((char*)p, n);
+} GUARD_END
+
 Bench benches[] = {
-	BENCH( impls, MAX_MEM - 521, "utf8 count", bench_base ),
-	BENCH( impls, MAX_MEM - 521, "utf8 count aligned", bench_aligned )
+	BENCH( impls, MAX_MEM - 521, "utf8 count", bench_base, guard_base ),
+	BENCH( impls, MAX_MEM - 521, "utf8 count aligned", bench_aligned ),
+	BENCH( impls, 1024, "utf8 count latency", bench_latency, .calls = CHAIN_CALLS ),
+	BENCH( impls, 1024, "utf8 count throughput", bench_throughput, .calls = CHAIN_CALLS )
 }; BENCH_MAIN(benches)
 
 
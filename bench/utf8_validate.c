@@ -0,0 +1,159 @@
+#include "bench.h"
+#include "../vector-utf/scalar.h"
+
+/* the rvv impls build their tables from 64-bit immediates */
+#if __riscv_xlen != 32 && __riscv_v_elen >= 64
+# define RVV(f) \
+	f(rvv_m1) f(rvv_ascii_m1) \
+	f(rvv_m2) f(rvv_ascii_m2)
+#else
+# define RVV(f)
+#endif
+
+#define IMPLS(f) \
+	f(scalar) \
+	RVV(f) \
+
+typedef int Func(char const *src, size_t len);
+
+#define DECLARE(f) extern Func utf8_validate_##f;
+IMPLS(DECLARE)
+
+#define EXTRACT(f) { #f, &utf8_validate_##f, 0 },
+Impl impls[] = { IMPLS(EXTRACT) };
+
+enum { ASCII, TWO, CJK, EMOJI, KINDS };
+
+/* every input holds valid UTF-8 with a mix of printable ASCII and code
+ * points from: U+0080 to U+07FF, the CJK unified ideographs, and the emoji
+ * blocks from U+1F300 to U+1FAFF */
+static uint32_t
+gen_codepoint(int kind)
+{
+	uint32_t r = bench_urand(), c = r >> 8;
+	switch (kind) {
+	case TWO:   if (r & 1) return 0x80 + c % (0x800 - 0x80); break;
+	case CJK:   if (r & 7) return 0x4e00 + c % (0xa000 - 0x4e00); break;
+	case EMOJI: if (r & 3) return 0x1f300 + c % (0x1fb00 - 0x1f300); break;
+	}
+	return 32 + c % 95;
+}
+
+static size_t
+utf8_put(uint8_t *p, uint32_t c)
+{
+	if (c < 0x80) {
+		p[0] = c;
+		return 1;
+	} else if (c < 0x800) {
+		p[0] = 0xc0 | c >> 6;
+		p[1] = 0x80 | (c & 63);
+		return 2;
+	} else if (c < 0x10000) {
+		p[0] = 0xe0 | c >> 12;
+		p[1] = 0x80 | (c >> 6 & 63);
+		p[2] = 0x80 | (c & 63);
+		return 3;
+	}
+	p[0] = 0xf0 | c >> 18;
+	p[1] = 0x80 | (c >> 12 & 63);
+	p[2] = 0x80 | (c >> 6 & 63);
+	p[3] = 0x80 | (c & 63);
+	return 4;
+}
+
+#define TEXT_LEN (MAX_MEM/KINDS)
+
+uint8_t *text[KINDS];
+int last;
+
+void init(void) {
+	for (int k = 0; k < KINDS; ++k) {
+		uint8_t *p = text[k] = mem + k*TEXT_LEN, *end = p + TEXT_LEN - 4;
+		while (p < end)
+			p += utf8_put(p, gen_codepoint(k));
+		while (p < text[k] + TEXT_LEN)
+			*p++ = ' ';
+	}
+}
+
+ux checksum(size_t n) { return last; }
+
+/* the length is shortened to end on a character boundary */
+static size_t
+common(size_t n, int kind)
+{
+	while (n && (text[kind][n] & 0xc0) == 0x80)
+		--n;
+	return n;
+}
+
+BENCH_BEG(ascii) {
+	n = common(n, ASCII);
+	TIME last = f((char*)text[ASCII], n);
+} BENCH_END
+
+BENCH_BEG(two) {
+	n = common(n, TWO);
+	TIME last = f((char*)text[TWO], n);
+} BENCH_END
+
+BENCH_BEG(cjk) {
+	n = common(n, CJK);
+	TIME last = f((char*)text[CJK], n);
+} BENCH_END
+
+BENCH_BEG(emoji) {
+	n = common(n, EMOJI);
+	TIME last = f((char*)text[EMOJI], n);
+} BENCH_END
+
+/* invalid sequences, which are invalid after any complete character */
+static struct { size_t len; uint8_t b[4]; } const invalid[] = {
+	{ 2, { 0xc0, 0x80 } },             /* overlong 2-byte */
+	{ 3, { 0xe0, 0x80, 0x80 } },       /* overlong 3-byte */
+	{ 4, { 0xf0, 0x80, 0x80, 0x80 } }, /* overlong 4-byte */
+	{ 3, { 0xed, 0xa0, 0x80 } },       /* surrogate */
+	{ 4, { 0xf4, 0x90, 0x80, 0x80 } }, /* above U+10FFFF */
+	{ 3, { 0xe4, 0xb8, 'a' } },        /* truncated */
+	{ 1, { 0x80 } },                   /* bad continuation */
+	{ 1, { 0xff } },                   /* invalid byte */
+};
+
+/* a random text, with one invalid sequence at a random character boundary,
+ * so the impls are compared on the error detection */
+BENCH_BEG(invalid) {
+	int kind = bench_urand() % KINDS;
+	uint8_t *p = text[kind], save[4];
+	n = common(n, kind);
+	size_t k = bench_urand() % ARR_LEN(invalid), len = invalid[k].len, i = 0;
+	if (n < len)
+		k = ARR_LEN(invalid) - 2, len = 1;
+	if (n) {
+		i = bench_urand() % (n - len + 1);
+		while (i && (p[i] & 0xc0) == 0x80)
+			--i;
+		memcpy(save, p + i, len);
+		memcpy(p + i, invalid[k].b, len);
+	}
+	TIME last = f((char*)p, n);
+	if (n)
+		memcpy(p + i, save, len);
+} BENCH_END
+
+/* valid text, but cut at random lengths, with a random byte flipped in every
+ * other run */
+GUARD_BEG(base) {
+	memcpy(p, text[n % KINDS], n);
+	if (n && bench_urand() & 1)
+		p[bench_urand() % n] ^= 1 << bench_urand() % 8;
+	return f((char*)p, n);
+} GUARD_END
+
+Bench benches[] = {
+	BENCH( impls, TEXT_LEN - 4, "utf8 validate ascii", bench_ascii, guard_base ),
+	BENCH( impls, TEXT_LEN - 4, "utf8 validate 2-byte", bench_two ),
+	BENCH( impls, TEXT_LEN - 4, "utf8 validate CJK", bench_cjk ),
+	BENCH( impls, TEXT_LEN - 4, "utf8 validate emoji", bench_emoji ),
+	BENCH( impls, TEXT_LEN - 4, "utf8 validate invalid", bench_invalid ),
+}; BENCH_MAIN(benches)
@@ -246,6 +246,17 @@ rv_cycles(void)
 }
 #endif
 
+/* constant rate wall-clock, unaffected by DVFS, 0 if unavailable */
+static inline ux
+rv_time(void)
+{
+	ux time = 0;
+#if !defined(READ_MCYCLE) /* M-mode only has the memory mapped mtime */
+	__asm__ volatile ("csrr %0, time" : "=r"(time));
+#endif
+	return time;
+}
+
 
 static void
 memswap(void *a, void *b, size_t size)
@@ -546,6 +557,25 @@ static const char PRINT_A = 0, PRINT_B = 0;
 #define IF_VF16(...)
 #endif
 
+/* only the conversions between f16 or bf16 and f32 */
+#if __riscv_zvfhmin >= 1000000 || __riscv_zvfh >= 1000000
+#define IF_VF16MIN(...) __VA_ARGS__
+#else
+#define IF_VF16MIN(...)
+#endif
+
+#if __riscv_zvfbfmin >= 1000000
+#define IF_VBF16MIN(...) __VA_ARGS__
+#else
+#define IF_VBF16MIN(...)
+#endif
+
+#if __riscv_zvfbfwma >= 1000000
+#define IF_VBF16WMA(...) __VA_ARGS__
+#else
+#define IF_VBF16WMA(...)
+#endif
+
 #if __riscv_flen == 64
 #define IF_F64(...) __VA_ARGS__
 #else
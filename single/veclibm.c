@@ -1,12 +1,19 @@
 #include <riscv_vector.h>
 
+#include <float.h>
 #include <math.h>
-#include <stdlib.h>
-#include <stdio.h>
 
-#ifndef N
-#define N (1024*128) /* change me */
-#endif
+#include "../bench/bench.h"
+
+#define MAX_N (1024*128)
+#define REPORT_N (1024*64)
+#define MAX_DOMAINS 4
+/* The checksum counts the results further than this from libm. It's a
+ * loose bound that only catches wrong results, the ulp report printed
+ * before the benchmarks measures the actual accuracy. */
+#define CHECK_ULP 256
+/* mismatched NaNs and infinities */
+#define MAX_ULP 0x1p53
 
 static void
 rvvlm_sqrt(size_t x_len, const double *x, double *y)
@@ -18,77 +25,284 @@ rvvlm_sqrt(size_t x_len, const double *x, double *y)
     }
 }
 
+#define F64_CHUNK 256
+
+/* f on f32 data, widened and narrowed through buffers */
+static void
+via_f64(void (*f)(size_t, const double *, double *), size_t x_len, const float *x, float *y)
+{
+	double a[F64_CHUNK], b[F64_CHUNK];
+	for (size_t n; x_len > 0; x_len -= n, x += n, y += n) {
+		n = x_len < F64_CHUNK ? x_len : F64_CHUNK;
+		for (size_t vl, i = 0; i < n; i += vl) {
+			vl = __riscv_vsetvl_e32m4(n - i);
+			__riscv_vse64(a + i, __riscv_vfwcvt_f(__riscv_vle32_v_f32m4(x + i, vl), vl), vl);
+		}
+		f(n, a, b);
+		for (size_t vl, i = 0; i < n; i += vl) {
+			vl = __riscv_vsetvl_e64m8(n - i);
+			__riscv_vse32(y + i, __riscv_vfncvt_f(__riscv_vle64_v_f64m8(b + i, vl), vl), vl);
+		}
+	}
+}
+
+/* inputs uniform in [lo,hi], or 2^[lo,hi] */
+typedef struct { double lo, hi; int pow2; char const *name; } Domain;
+#define LIN(lo,hi) { lo, hi, 0, "[" #lo "," #hi "]" }
+#define POW2(lo,hi) { lo, hi, 1, "2^[" #lo "," #hi "]" }
+
+/* the first domain is the one benchmarked */
 #define APPLY(X) \
-X(exp) X(exp2) X(expm1) X(log) X(log10) X(log2) X(log1p) \
-X(sqrt) X(cbrt) \
-X(sin) X(cos) X(tan) X(asin) X(acos) X(atan) \
-X(sinh) X(cosh) X(tanh) X(asinh) X(acosh) X(atanh) \
-X(erf) X(erfc) X(tgamma) X(lgamma)
+X(exp, LIN(-1,1), LIN(-700,700)) \
+X(exp2, LIN(-1,1), LIN(-1000,1000)) \
+X(expm1, LIN(-1,1), LIN(-700,700), POW2(-50,-1)) \
+X(log, LIN(0.5,2), POW2(-1000,1000)) \
+X(log10, LIN(0.5,2), POW2(-1000,1000)) \
+X(log2, LIN(0.5,2), POW2(-1000,1000)) \
+X(log1p, LIN(-0.5,1), POW2(-50,1000)) \
+X(sqrt, LIN(0,1), POW2(-1000,1000)) \
+X(cbrt, LIN(-1,1), POW2(-1000,1000)) \
+X(sin, LIN(-3.14,3.14), LIN(-1e6,1e6)) \
+X(cos, LIN(-3.14,3.14), LIN(-1e6,1e6)) \
+X(tan, LIN(-1.5,1.5), LIN(-1e6,1e6)) \
+X(asin, LIN(-1,1)) \
+X(acos, LIN(-1,1)) \
+X(atan, LIN(-1,1), POW2(-100,100)) \
+X(sinh, LIN(-1,1), LIN(-700,700)) \
+X(cosh, LIN(-1,1), LIN(-700,700)) \
+X(tanh, LIN(-1,1), LIN(-20,20)) \
+X(asinh, LIN(-1,1), POW2(-100,100)) \
+X(acosh, LIN(1,2), POW2(0,1000)) \
+X(atanh, LIN(-1,1)) \
+X(erf, LIN(-1,1), LIN(-6,6)) \
+X(erfc, LIN(-1,1), LIN(-6,27)) \
+X(tgamma, LIN(0.5,10), LIN(1,170)) \
+X(lgamma, LIN(3,100), LIN(0.5,1e5))
+
+typedef void Func(size_t x_len, const double *x, double *y);
 
-#define DECLARE(f) void rvvlm_##f(size_t x_len, const double *x, double *y);
+#define DECLARE(f,...) void rvvlm_##f(size_t x_len, const double *x, double *y);
 APPLY(DECLARE)
 
-#define DEFINE(f) \
+#define DEFINE(f,...) \
 	static void lm_##f(size_t x_len, const double *x, double *y) { \
 		for (size_t i = 0; i < x_len; ++i) y[i] = f(x[i]); \
-	}
+	} \
+	static Domain const domains_##f[] = { __VA_ARGS__ }; \
+	Impl impls_##f[] = { { "libm", &lm_##f, 0 }, { "rvvlm", &rvvlm_##f, 0 } };
 APPLY(DEFINE)
-struct Func {
-	void (*rvvlm)(size_t, const double*, double*);
-	void (*lm)(size_t, const double*, double*);
-	const char *name;
+
+/* The f32 functions, with the f32 libm, the f64 rvvlm and the two tiers
+ * of veclibmf.c, whose relaxed one only supports the inputs of the first
+ * two domains. */
+#define APPLYF(X) \
+X(exp, expf, LIN(-1,1), LIN(-87,88)) \
+X(log, logf, LIN(0.5,2), POW2(-126,127)) \
+X(sin, sinf, LIN(-3.14,3.14), LIN(-1e6,1e6)) \
+X(cos, cosf, LIN(-3.14,3.14), LIN(-1e6,1e6)) \
+X(tanh, tanhf, LIN(-1,1), LIN(-10,10)) \
+X(erf, erff, LIN(-1,1), LIN(-5,5))
+
+typedef void FuncF(size_t x_len, const float *x, float *y);
+
+#define DECLAREF(f,...) \
+	void rvvlmf_##f(size_t x_len, const float *x, float *y); \
+	void rvvlmf_##f##_relaxed(size_t x_len, const float *x, float *y);
+APPLYF(DECLAREF)
+
+#define DEFINEF(f,lm,...) \
+	static void lmf_##f(size_t x_len, const float *x, float *y) { \
+		for (size_t i = 0; i < x_len; ++i) y[i] = lm(x[i]); \
+	} \
+	static void rvvlm_f64_##f(size_t x_len, const float *x, float *y) { \
+		via_f64(rvvlm_##f, x_len, x, y); \
+	} \
+	static Domain const domainsf_##f[] = { __VA_ARGS__ }; \
+	Impl implsf_##f[] = { \
+		{ "libm", &lmf_##f, 0 }, { "rvvlm_f64", &rvvlm_f64_##f, 0 }, \
+		{ "rvvlmf", &rvvlmf_##f, 0 }, { "rvvlmf_relaxed", &rvvlmf_##f##_relaxed, 0 }, \
+	};
+APPLYF(DEFINEF)
+
+#define ENUM(f,...) F_##f,
+#define ENUMF(f,...) FF_##f,
+enum { APPLY(ENUM) APPLYF(ENUMF) };
+
+struct Fn {
+	Func *rvvlm, *lm;
+	char const *name;
+	Domain const *domains;
+	size_t nDomains;
 };
 
-struct Func funcs[] = {
-#define ENTRY(f) { rvvlm_##f, lm_##f, #f },
+struct Fn funcs[] = {
+#define ENTRY(f,...) { rvvlm_##f, lm_##f, #f, domains_##f, ARR_LEN(domains_##f) },
 APPLY(ENTRY)
 };
 
-typedef struct { uint64_t x, y, z; } URand;
+struct FnF {
+	Impl *impls;
+	size_t nImpls;
+	double (*ref)(double);
+	char const *name;
+	Domain const *domains;
+	size_t nDomains;
+} funcsf[] = {
+#define ENTRYF(f,...) { implsf_##f, ARR_LEN(implsf_##f), f, #f, domainsf_##f, ARR_LEN(domainsf_##f) },
+APPLYF(ENTRYF)
+};
+
+static double *in, *out, *ref;
+static size_t last, lastFunc, filled = -1;
 
-/* RomuDuoJr, see https://romu-random.org/ */
-static inline uint64_t
-urand(URand *r)
+static void
+fill(double *x, size_t n, Domain d)
 {
-#define ROTL(x,n) (((x) << (n)) | ((x) >> (8*sizeof(x) - (n))))
-	uint64_t xp = r->x, yp = r->y, zp = r->z;
-	r->x = 15241094284759029579u * zp;
-	r->y = ROTL(yp - xp, 12);
-	r->z = ROTL(zp - yp, 44);
-	return xp;
+	for (size_t i = 0; i < n; ++i) {
+		double u = d.lo + (d.hi - d.lo) * ((bench_urand() >> 11) * 0x1p-53);
+		x[i] = d.pow2 ? exp2(u) : u;
+	}
 }
 
+static void
+fillf(float *x, size_t n, Domain d)
+{
+	fill(ref, n, d);
+	for (size_t i = 0; i < n; ++i)
+		x[i] = ref[i];
+}
+
+static double
+ulp_error(double y, double r)
+{
+	if (isnan(y) || isnan(r))
+		return isnan(y) && isnan(r) ? 0 : MAX_ULP;
+	if (y == r)
+		return 0;
+	if (isinf(y) || isinf(r))
+		return MAX_ULP;
+	double e = fabs(y - r) / (nextafter(fabs(r), INFINITY) - fabs(r));
+	return e > MAX_ULP ? MAX_ULP : e;
+}
+
+/* in ulp of the f32 result */
+static double
+ulp_errorf(float y, double r)
+{
+	if (isnan(y) || isnan(r))
+		return isnan(y) && isnan(r) ? 0 : MAX_ULP;
+	if (isinf(y) || isinf((float)r))
+		return y == (float)r ? 0 : MAX_ULP;
+	int e = r == 0 ? FLT_MIN_EXP-1 : ilogb(r);
+	e = e < FLT_MIN_EXP-1 ? FLT_MIN_EXP-1 : e;
+	double u = fabs(y - r) / ldexp(1, e - (FLT_MANT_DIG-1));
+	return u > MAX_ULP ? MAX_ULP : u;
+}
+
+static void
+print_errors(Domain const *domains, size_t nDomains, double const *max, double const *mean)
+{
+	print("domains: [");
+	for (size_t d = 0; d < nDomains; ++d)
+		print("\"")(s,domains[d].name)("\",");
+	print("],\nmax: [");
+	for (size_t d = 0; d < nDomains; ++d)
+		print(fn,3,max[d])(",");
+	print("],\nmean: [");
+	for (size_t d = 0; d < nDomains; ++d)
+		print(fn,3,mean[d])(",");
+	print("]\n},\n")(flush,);
+}
 
-int
-main(void)
+/* the maximum and mean ulp error of rvvlm against libm in each domain, and
+ * of each f32 impl against the f64 libm */
+static void
+report(void)
 {
-	double *in = malloc(N*sizeof *in), *out = malloc(N*sizeof *out);
-	URand r = {123, (uintptr_t)&in, (uintptr_t)&out};
-
-	for (size_t i = 0; i < N; ++i)
-		in[i] = (urand(&r) >> (64 - 53)) * (1.0 / (1ull << 53));
-
-	for (size_t i = 0; i < sizeof funcs / sizeof *funcs; ++i) {
-		size_t beg, end;
-		struct Func f = funcs[i];
-		printf("%s libm: ", f.name);
-		for (size_t i = 0; i < 3; ++i) {
-			__asm__ volatile ("csrr %0, cycle" : "=r"(beg));
-			f.lm(N, in, out);
-			__asm__ volatile ("csrr %0, cycle" : "=r"(end));
-			printf(" %f", ((double)N) / (end-beg));
+	double max[MAX_DOMAINS], mean[MAX_DOMAINS];
+	for (struct Fn *f = funcs; f != funcs + ARR_LEN(funcs); ++f) {
+		for (size_t d = 0; d < f->nDomains; ++d) {
+			max[d] = mean[d] = 0;
+			fill(in, REPORT_N, f->domains[d]);
+			f->lm(REPORT_N, in, ref);
+			f->rvvlm(REPORT_N, in, out);
+			for (size_t i = 0; i < REPORT_N; ++i) {
+				double e = ulp_error(out[i], ref[i]);
+				max[d] = e > max[d] ? e : max[d];
+				mean[d] += e / REPORT_N;
+			}
 		}
-		printf(" elements/cycle\n%s rvvlm:", f.name);
-		for (size_t i = 0; i < 3; ++i) {
-			__asm__ volatile ("csrr %0, cycle" : "=r"(beg));
-			f.rvvlm(N, in, out);
-			__asm__ volatile ("csrr %0, cycle" : "=r"(end));
-			printf(" %f", ((double)N) / (end-beg));
+		print("{\ntitle: \"")(s,f->name)(" ulp error\",\n");
+		print_errors(f->domains, f->nDomains, max, mean);
+	}
+
+	float *x = (float*)in, *y = (float*)out;
+	for (struct FnF *f = funcsf; f != funcsf + ARR_LEN(funcsf); ++f) {
+		for (Impl *im = f->impls; im != f->impls + f->nImpls; ++im) {
+			for (size_t d = 0; d < f->nDomains; ++d) {
+				max[d] = mean[d] = 0;
+				fillf(x, REPORT_N, f->domains[d]);
+				((FuncF*)im->func)(REPORT_N, x, y);
+				for (size_t i = 0; i < REPORT_N; ++i) {
+					double e = ulp_errorf(y[i], f->ref(x[i]));
+					max[d] = e > max[d] ? e : max[d];
+					mean[d] += e / REPORT_N;
+				}
+			}
+			print("{\ntitle: \"")(s,f->name)(" f32 ")(s,im->name)(" ulp error\",\n");
+			print_errors(f->domains, f->nDomains, max, mean);
 		}
-		printf(" elements/cycle\n");
 	}
-	free(in);
-	free(out);
-	return 0;
 }
 
+void init(void) {
+	in = (double*)mem;
+	out = in + MAX_N;
+	ref = out + MAX_N;
+	report();
+}
+
+/* the f32 results are compared with the f32 libm */
+ux checksum(size_t n) {
+	ux bad = 0;
+	if (lastFunc < ARR_LEN(funcs)) {
+		funcs[lastFunc].lm(last, in, ref);
+		for (size_t i = 0; i < last; ++i)
+			bad += ulp_error(out[i], ref[i]) > CHECK_ULP;
+	} else {
+		float *x = (float*)in, *y = (float*)out, *r = (float*)ref;
+		((FuncF*)funcsf[lastFunc - ARR_LEN(funcs)].impls[0].func)(last, x, r);
+		for (size_t i = 0; i < last; ++i)
+			bad += ulp_errorf(y[i], r[i]) > CHECK_ULP;
+	}
+	return bad;
+}
+
+/* fills the input of the function once, for the largest size */
+#define BENCHES(fn,...) \
+	BENCH_BEG(fn) { \
+		if (filled != F_##fn) \
+			fill(in, MAX_N, domains_##fn[0]), filled = F_##fn; \
+		n /= sizeof(double); \
+		last = n, lastFunc = F_##fn; \
+		TIME f(n, in, out); \
+	} BENCH_END
+APPLY(BENCHES)
+
+#define BENCHESF(fn,...) \
+	BENCH_BEG(fn##_f32) { \
+		FuncF *g = _func; \
+		if (filled != FF_##fn) \
+			fillf((float*)in, MAX_N, domainsf_##fn[0]), filled = FF_##fn; \
+		n /= sizeof(float); \
+		last = n, lastFunc = FF_##fn; \
+		TIME g(n, (float*)in, (float*)out); \
+	} BENCH_END
+APPLYF(BENCHESF)
+
+Bench benches[] = {
+#define BENCH_ENTRY(f,...) BENCH( impls_##f, MAX_N*sizeof(double), #f " f64", bench_##f ),
+APPLY(BENCH_ENTRY)
+#define BENCH_ENTRYF(f,...) BENCH( implsf_##f, MAX_N*sizeof(float), #f " f32", bench_##f##_f32 ),
+APPLYF(BENCH_ENTRYF)
+}; BENCH_MAIN(benches)
@@ -0,0 +1,335 @@
+#include <riscv_vector.h>
+
+#include <stddef.h>
+#include <math.h>
+
+/* f32 exp, log, sin, cos, tanh and erf in two accuracy tiers.
+ *
+ * The rvvlmf_* functions widen the input to f64 and evaluate polynomials
+ * accurate to about 2^-32 there, so the final rounding to f32 dominates
+ * the error, which stays within 0.51 ulp. They handle special inputs,
+ * overflow and subnormal results like libm, except that sin and cos only
+ * reduce the argument accurately for |x| < 2^28.
+ *
+ * The rvvlmf_*_relaxed functions stay in f32, with shorter polynomials,
+ * and only support finite inputs, without subnormals:
+ * - exp is within 3 ulp, and clamps x to [-87,88.3], so the result is
+ *   never 0, inf or subnormal
+ * - log is within 3 ulp for positive normal numbers
+ * - sin and cos are within 2 ulp, reducing the argument in f32, which
+ *   holds up for |x| < 2^20
+ * - tanh and erf are Eigen's rational approximations, within 5 and 8 ulp,
+ *   most of it from evaluating them in f32
+ *
+ * The full tier works on e32m1 widened to e64m2, the relaxed one on e32m2,
+ * so both process the same number of elements per iteration. */
+
+/* c[0] + c[1]*x + ... + c[n-1]*x^(n-1) with Horner's rule */
+static inline vfloat64m2_t
+poly_f64(vfloat64m2_t x, double const *c, size_t n, size_t vl)
+{
+	vfloat64m2_t p = __riscv_vfmv_v_f_f64m2(c[n-1], vl);
+	while (n-- > 1)
+		p = __riscv_vfmadd_vv_f64m2(p, x, __riscv_vfmv_v_f_f64m2(c[n-1], vl), vl);
+	return p;
+}
+
+static inline vfloat32m2_t
+poly_f32(vfloat32m2_t x, float const *c, size_t n, size_t vl)
+{
+	vfloat32m2_t p = __riscv_vfmv_v_f_f32m2(c[n-1], vl);
+	while (n-- > 1)
+		p = __riscv_vfmadd_vv_f32m2(p, x, __riscv_vfmv_v_f_f32m2(c[n-1], vl), vl);
+	return p;
+}
+
+/* 1/n! */
+static double const exp_f64_poly[] = {
+	1, 1, 1/2.0, 1/6.0, 1/24.0, 1/120.0, 1/720.0, 1/5040.0, 1/40320.0
+};
+
+/* exp(x) for x in [-104,89], x = k*ln(2) + r with |r| <= ln(2)/2, and
+ * a degree 8 Taylor polynomial of exp(r), so 2^k is always a normal f64 */
+static inline vfloat64m2_t
+exp_f64(vfloat64m2_t x, size_t vl)
+{
+	vint64m2_t k = __riscv_vfcvt_x_f_v_i64m2(__riscv_vfmul_vf_f64m2(x, 0x1.71547652b82fep0, vl), vl);
+	vfloat64m2_t kf = __riscv_vfcvt_f_x_v_f64m2(k, vl);
+	vfloat64m2_t r = __riscv_vfnmsac_vf_f64m2(x, 0x1.62e42fee00000p-1, kf, vl);
+	r = __riscv_vfnmsac_vf_f64m2(r, 0x1.a39ef35793c76p-33, kf, vl);
+	vfloat64m2_t p = poly_f64(r, exp_f64_poly, 9, vl);
+	vint64m2_t e = __riscv_vsll_vx_i64m2(k, 52, vl);
+	e = __riscv_vadd_vv_i64m2(__riscv_vreinterpret_v_f64m2_i64m2(p), e, vl);
+	return __riscv_vreinterpret_v_i64m2_f64m2(e);
+}
+
+void
+rvvlmf_exp(size_t x_len, const float *x, float *y)
+{
+	for (size_t vl; x_len > 0; x_len -= vl, x += vl, y += vl) {
+		vl = __riscv_vsetvl_e32m1(x_len);
+		vfloat32m1_t v = __riscv_vle32_v_f32m1(x, vl);
+		vfloat64m2_t d = __riscv_vfwcvt_f_f_v_f64m2(v, vl);
+		d = __riscv_vfmin_vf_f64m2(__riscv_vfmax_vf_f64m2(d, -104, vl), 89, vl);
+		vfloat32m1_t r = __riscv_vfncvt_f_f_w_f32m1(exp_f64(d, vl), vl);
+		vbool32_t nan = __riscv_vmfne_vv_f32m1_b32(v, v, vl);
+		__riscv_vse32_v_f32m1(y, __riscv_vmerge_vvm_f32m1(r, v, nan, vl), vl);
+	}
+}
+
+/* 2/(2n+1) */
+static double const log_f64_poly[] = {
+	2, 2/3.0, 2/5.0, 2/7.0, 2/9.0, 2/11.0
+};
+
+/* x = 2^e * m with m in [sqrt(2)/2,sqrt(2)), and log(m) = 2*atanh(s) with
+ * s = (m-1)/(m+1), so |s| < 0.172. The widened input is never subnormal. */
+void
+rvvlmf_log(size_t x_len, const float *x, float *y)
+{
+	for (size_t vl; x_len > 0; x_len -= vl, x += vl, y += vl) {
+		vl = __riscv_vsetvl_e32m1(x_len);
+		vfloat32m1_t v = __riscv_vle32_v_f32m1(x, vl);
+		vint64m2_t i = __riscv_vreinterpret_v_f64m2_i64m2(__riscv_vfwcvt_f_f_v_f64m2(v, vl));
+		vint64m2_t e = __riscv_vsra_vx_i64m2(__riscv_vsub_vx_i64m2(i, 0x3fe6a09e667f3bcd, vl), 52, vl);
+		i = __riscv_vsub_vv_i64m2(i, __riscv_vsll_vx_i64m2(e, 52, vl), vl);
+		vfloat64m2_t f = __riscv_vfsub_vf_f64m2(__riscv_vreinterpret_v_i64m2_f64m2(i), 1, vl);
+		vfloat64m2_t s = __riscv_vfdiv_vv_f64m2(f, __riscv_vfadd_vf_f64m2(f, 2, vl), vl);
+		vfloat64m2_t p = poly_f64(__riscv_vfmul_vv_f64m2(s, s, vl), log_f64_poly, 6, vl);
+		p = __riscv_vfmul_vv_f64m2(p, s, vl);
+		p = __riscv_vfmacc_vf_f64m2(p, 0x1.62e42fefa39efp-1, __riscv_vfcvt_f_x_v_f64m2(e, vl), vl);
+		vfloat32m1_t r = __riscv_vfncvt_f_f_w_f32m1(p, vl);
+		/* inf and NaN return themselves, negative numbers NaN, and 0 -inf */
+		vbool32_t m = __riscv_vmnot_m_b32(__riscv_vmflt_vf_f32m1_b32(v, INFINITY, vl), vl);
+		r = __riscv_vmerge_vvm_f32m1(r, v, m, vl);
+		m = __riscv_vmflt_vf_f32m1_b32(v, 0, vl);
+		r = __riscv_vfmerge_vfm_f32m1(r, NAN, m, vl);
+		m = __riscv_vmfeq_vf_f32m1_b32(v, 0, vl);
+		r = __riscv_vfmerge_vfm_f32m1(r, -INFINITY, m, vl);
+		__riscv_vse32_v_f32m1(y, r, vl);
+	}
+}
+
+/* sin(r)/r and cos(r) in z = r^2 for |r| <= pi/4, from musl's __sindf
+ * and __cosdf */
+static double const sin_f64_poly[] = {
+	1, -0x15555554cbac77.0p-55, 0x111110896efbb2.0p-59,
+	-0x1a00f9e2cae774.0p-65, 0x16cd878c3b46a7.0p-71
+};
+static double const cos_f64_poly[] = {
+	1, -0x1ffffffd0c5e81.0p-54, 0x155553e1053a42.0p-57,
+	-0x16c087e80f1e27.0p-62, 0x199342e0ee5069.0p-68
+};
+
+/* x = n*pi/2 + r, with pi/2 split into 33 and 53 bits, like musl's
+ * __rem_pio2f. The quadrant n, plus one for cos, selects the polynomial
+ * with its lowest bit, and the sign with the next one. */
+static inline void
+sincos_f64(const float *x, float *y, size_t x_len, int cosine)
+{
+	for (size_t vl; x_len > 0; x_len -= vl, x += vl, y += vl) {
+		vl = __riscv_vsetvl_e32m1(x_len);
+		vfloat32m1_t v = __riscv_vle32_v_f32m1(x, vl);
+		vfloat64m2_t d = __riscv_vfwcvt_f_f_v_f64m2(v, vl);
+		vint64m2_t n = __riscv_vfcvt_x_f_v_i64m2(__riscv_vfmul_vf_f64m2(d, 0x1.45f306dc9c883p-1, vl), vl);
+		vfloat64m2_t nf = __riscv_vfcvt_f_x_v_f64m2(n, vl);
+		d = __riscv_vfnmsac_vf_f64m2(d, 0x1.921fb5p0, nf, vl);
+		d = __riscv_vfnmsac_vf_f64m2(d, 0x1.110b4611a6263p-26, nf, vl);
+		vfloat64m2_t z = __riscv_vfmul_vv_f64m2(d, d, vl);
+		vfloat64m2_t s = __riscv_vfmul_vv_f64m2(poly_f64(z, sin_f64_poly, 5, vl), d, vl);
+		vfloat64m2_t c = poly_f64(z, cos_f64_poly, 5, vl);
+		n = __riscv_vadd_vx_i64m2(n, cosine, vl);
+		vbool32_t odd = __riscv_vmsne_vx_i64m2_b32(__riscv_vand_vx_i64m2(n, 1, vl), 0, vl);
+		vint64m2_t i = __riscv_vreinterpret_v_f64m2_i64m2(__riscv_vmerge_vvm_f64m2(s, c, odd, vl));
+		i = __riscv_vxor_vv_i64m2(i, __riscv_vsll_vx_i64m2(__riscv_vand_vx_i64m2(n, 2, vl), 62, vl), vl);
+		vfloat32m1_t r = __riscv_vfncvt_f_f_w_f32m1(__riscv_vreinterpret_v_i64m2_f64m2(i), vl);
+		/* NaN for inf and NaN */
+		vbool32_t m = __riscv_vmnot_m_b32(__riscv_vmflt_vf_f32m1_b32(__riscv_vfabs_v_f32m1(v, vl), INFINITY, vl), vl);
+		r = __riscv_vmerge_vvm_f32m1(r, __riscv_vfsub_vv_f32m1(v, v, vl), m, vl);
+		__riscv_vse32_v_f32m1(y, r, vl);
+	}
+}
+
+void rvvlmf_sin(size_t x_len, const float *x, float *y) { sincos_f64(x, y, x_len, 0); }
+void rvvlmf_cos(size_t x_len, const float *x, float *y) { sincos_f64(x, y, x_len, 1); }
+
+/* tanh(|x|) = 1 - 2/(exp(2|x|)+1), which is 1 in f32 from 9.1, and |x|
+ * itself below 2^-12, where the subtraction would start to cancel */
+void
+rvvlmf_tanh(size_t x_len, const float *x, float *y)
+{
+	for (size_t vl; x_len > 0; x_len -= vl, x += vl, y += vl) {
+		vl = __riscv_vsetvl_e32m1(x_len);
+		vfloat32m1_t v = __riscv_vle32_v_f32m1(x, vl);
+		vfloat32m1_t a = __riscv_vfabs_v_f32m1(v, vl);
+		vfloat64m2_t d = __riscv_vfwcvt_f_f_v_f64m2(__riscv_vfmin_vf_f32m1(a, 9.1f, vl), vl);
+		d = exp_f64(__riscv_vfadd_vv_f64m2(d, d, vl), vl);
+		d = __riscv_vfrdiv_vf_f64m2(__riscv_vfadd_vf_f64m2(d, 1, vl), 2, vl);
+		vfloat32m1_t r = __riscv_vfncvt_f_f_w_f32m1(__riscv_vfrsub_vf_f64m2(d, 1, vl), vl);
+		vbool32_t m = __riscv_vmnot_m_b32(__riscv_vmfge_vf_f32m1_b32(a, 0x1p-12f, vl), vl);
+		r = __riscv_vmerge_vvm_f32m1(r, a, m, vl);
+		__riscv_vse32_v_f32m1(y, __riscv_vfsgnj_vv_f32m1(r, v, vl), vl);
+	}
+}
+
+/* erf(x)/x in x^2 for |x| <= 1.25, and erfc(x)*exp(x^2) in x-2.625 for
+ * x in [1.25,4], both minimax fits with a relative error below 2^-29 */
+static double const erf_small_poly[] = {
+	0x1.20dd7503fa504p+0, -0x1.81274665f0da2p-2, 0x1.ce2f0e3e13346p-4,
+	-0x1.b82aebac1ee58p-6, 0x1.5641f9ff43867p-8, -0x1.beac6b1906b3cp-11,
+	0x1.ec3bee34baac1p-14, -0x1.ad3c3c4dc07d4p-17, 0x1.bb873d5c0edf1p-21
+};
+static double const erf_large_poly[] = {
+	0x1.9d7738e0c3673p-3, -0x1.18737a719525fp-4, 0x1.6afd3c959636bp-6,
+	-0x1.c28e576b5c7e8p-8, 0x1.0d40968f3a665p-9, -0x1.36d81c53171e4p-11,
+	0x1.5bcc3083f11a7p-13, -0x1.7bd23ab04d413p-15, 0x1.908c686e72eddp-17,
+	-0x1.8064c898fce76p-19, 0x1.8a14c99acdfb6p-21, -0x1.223ad63eb9d97p-22,
+	0x1.0c4b8c5482f22p-24
+};
+
+/* erf(|x|) rounds to 1 from 3.92, so |x| is clamped to 4 */
+void
+rvvlmf_erf(size_t x_len, const float *x, float *y)
+{
+	for (size_t vl; x_len > 0; x_len -= vl, x += vl, y += vl) {
+		vl = __riscv_vsetvl_e32m1(x_len);
+		vfloat32m1_t v = __riscv_vle32_v_f32m1(x, vl);
+		vfloat32m1_t a = __riscv_vfmin_vf_f32m1(__riscv_vfabs_v_f32m1(v, vl), 4, vl);
+		vfloat64m2_t d = __riscv_vfwcvt_f_f_v_f64m2(a, vl);
+		vfloat64m2_t z = __riscv_vfmul_vv_f64m2(d, d, vl);
+		vfloat64m2_t s = __riscv_vfmul_vv_f64m2(poly_f64(z, erf_small_poly, 9, vl), d, vl);
+		vfloat64m2_t l = poly_f64(__riscv_vfsub_vf_f64m2(d, 2.625, vl), erf_large_poly, 13, vl);
+		l = __riscv_vfmul_vv_f64m2(l, exp_f64(__riscv_vfneg_v_f64m2(z, vl), vl), vl);
+		l = __riscv_vfrsub_vf_f64m2(l, 1, vl);
+		vbool32_t m = __riscv_vmfgt_vf_f64m2_b32(d, 1.25, vl);
+		vfloat32m1_t r = __riscv_vfncvt_f_f_w_f32m1(__riscv_vmerge_vvm_f64m2(s, l, m, vl), vl);
+		r = __riscv_vfsgnj_vv_f32m1(r, v, vl);
+		m = __riscv_vmfne_vv_f32m1_b32(v, v, vl);
+		__riscv_vse32_v_f32m1(y, __riscv_vmerge_vvm_f32m1(r, v, m, vl), vl);
+	}
+}
+
+/* exp(r) = 1 + r + r^2*P(r) for |r| <= ln(2)/2, P is a degree 3 minimax fit */
+static float const exp_f32_poly[] = {
+	1, 1, 0x1.fffd5ep-2f, 0x1.555494p-3f, 0x1.576382p-5f, 0x1.123d92p-7f
+};
+
+/* like exp_f64, with 2^k added to the exponent field of the result */
+void
+rvvlmf_exp_relaxed(size_t x_len, const float *x, float *y)
+{
+	for (size_t vl; x_len > 0; x_len -= vl, x += vl, y += vl) {
+		vl = __riscv_vsetvl_e32m2(x_len);
+		vfloat32m2_t v = __riscv_vle32_v_f32m2(x, vl);
+		v = __riscv_vfmin_vf_f32m2(__riscv_vfmax_vf_f32m2(v, -87, vl), 88.3f, vl);
+		vint32m2_t k = __riscv_vfcvt_x_f_v_i32m2(__riscv_vfmul_vf_f32m2(v, 0x1.715476p0f, vl), vl);
+		vfloat32m2_t kf = __riscv_vfcvt_f_x_v_f32m2(k, vl);
+		v = __riscv_vfnmsac_vf_f32m2(v, 0x1.62e4p-1f, kf, vl);
+		v = __riscv_vfnmsac_vf_f32m2(v, 0x1.7f7d1cp-20f, kf, vl);
+		vint32m2_t p = __riscv_vreinterpret_v_f32m2_i32m2(poly_f32(v, exp_f32_poly, 6, vl));
+		p = __riscv_vadd_vv_i32m2(p, __riscv_vsll_vx_i32m2(k, 23, vl), vl);
+		__riscv_vse32_v_f32m2(y, __riscv_vreinterpret_v_i32m2_f32m2(p), vl);
+	}
+}
+
+/* log(1+r) = r + r^2*P(r) for r in [-1/3,1/3), P is a degree 7 minimax fit */
+static float const log_f32_poly[] = {
+	1, -0x1.ffffaep-2f, 0x1.55550cp-2f, -0x1.001f36p-2f, 0x1.99d28ep-3f,
+	-0x1.4eb23p-3f, 0x1.1e848ep-3f, -0x1.42e0ep-3f, 0x1.20822cp-3f
+};
+
+/* x = 2^e * (1+r), with 1+r in [2/3,4/3) */
+void
+rvvlmf_log_relaxed(size_t x_len, const float *x, float *y)
+{
+	for (size_t vl; x_len > 0; x_len -= vl, x += vl, y += vl) {
+		vl = __riscv_vsetvl_e32m2(x_len);
+		vint32m2_t i = __riscv_vreinterpret_v_f32m2_i32m2(__riscv_vle32_v_f32m2(x, vl));
+		i = __riscv_vsub_vx_i32m2(i, 0x3f2aaaab, vl);
+		vfloat32m2_t e = __riscv_vfcvt_f_x_v_f32m2(__riscv_vsra_vx_i32m2(i, 23, vl), vl);
+		i = __riscv_vadd_vx_i32m2(__riscv_vand_vx_i32m2(i, 0x7fffff, vl), 0x3f2aaaab, vl);
+		vfloat32m2_t r = __riscv_vfsub_vf_f32m2(__riscv_vreinterpret_v_i32m2_f32m2(i), 1, vl);
+		vfloat32m2_t p = __riscv_vfmul_vv_f32m2(poly_f32(r, log_f32_poly, 9, vl), r, vl);
+		__riscv_vse32_v_f32m2(y, __riscv_vfmacc_vf_f32m2(p, 0x1.62e430p-1f, e, vl), vl);
+	}
+}
+
+/* sin(r)/r and cos(r) in z = r^2 for |r| <= pi/4, minimax fits */
+static float const sin_f32_poly[] = {
+	1, -0x1.555546p-3f, 0x1.1106bap-7f, -0x1.99071ap-13f
+};
+static float const cos_f32_poly[] = {
+	1, -0.5f, 0x1.55553ep-5f, -0x1.6c07f4p-10f, 0x1.9906cap-16f
+};
+
+/* like sincos_f64, with pi/2 split into three floats */
+static inline void
+sincos_f32(const float *x, float *y, size_t x_len, int cosine)
+{
+	for (size_t vl; x_len > 0; x_len -= vl, x += vl, y += vl) {
+		vl = __riscv_vsetvl_e32m2(x_len);
+		vfloat32m2_t v = __riscv_vle32_v_f32m2(x, vl);
+		vint32m2_t n = __riscv_vfcvt_x_f_v_i32m2(__riscv_vfmul_vf_f32m2(v, 0x1.45f306p-1f, vl), vl);
+		vfloat32m2_t nf = __riscv_vfcvt_f_x_v_f32m2(n, vl);
+		v = __riscv_vfnmsac_vf_f32m2(v, 0x1.921fb6p0f, nf, vl);
+		v = __riscv_vfnmsac_vf_f32m2(v, -0x1.777a5cp-25f, nf, vl);
+		v = __riscv_vfnmsac_vf_f32m2(v, -0x1.ee59dap-50f, nf, vl);
+		vfloat32m2_t z = __riscv_vfmul_vv_f32m2(v, v, vl);
+		vfloat32m2_t s = __riscv_vfmul_vv_f32m2(poly_f32(z, sin_f32_poly, 4, vl), v, vl);
+		vfloat32m2_t c = poly_f32(z, cos_f32_poly, 5, vl);
+		n = __riscv_vadd_vx_i32m2(n, cosine, vl);
+		vbool16_t odd = __riscv_vmsne_vx_i32m2_b16(__riscv_vand_vx_i32m2(n, 1, vl), 0, vl);
+		vint32m2_t i = __riscv_vreinterpret_v_f32m2_i32m2(__riscv_vmerge_vvm_f32m2(s, c, odd, vl));
+		i = __riscv_vxor_vv_i32m2(i, __riscv_vsll_vx_i32m2(__riscv_vand_vx_i32m2(n, 2, vl), 30, vl), vl);
+		__riscv_vse32_v_f32m2(y, __riscv_vreinterpret_v_i32m2_f32m2(i), vl);
+	}
+}
+
+void rvvlmf_sin_relaxed(size_t x_len, const float *x, float *y) { sincos_f32(x, y, x_len, 0); }
+void rvvlmf_cos_relaxed(size_t x_len, const float *x, float *y) { sincos_f32(x, y, x_len, 1); }
+
+/* x*P(x^2)/Q(x^2), from Eigen's ptanh_float and generic_fast_erf_float */
+static float const tanh_f32_p[] = {
+	4.89352455891786e-03f, 6.37261928875436e-04f, 1.48572235717979e-05f,
+	5.12229709037114e-08f, -8.60467152213735e-11f, 2.00018790482477e-13f,
+	-2.76076847742355e-16f
+};
+static float const tanh_f32_q[] = {
+	4.89352518554385e-03f, 2.26843463243900e-03f, 1.18534705686654e-04f,
+	1.19825839466702e-06f
+};
+static float const erf_f32_p[] = {
+	-1.60960333262415e-02f, -2.95459980854025e-03f, -7.34990630326855e-04f,
+	-5.69250639462346e-05f, -2.10102402082508e-06f, 2.77068142495902e-08f,
+	-2.72614225801306e-10f
+};
+static float const erf_f32_q[] = {
+	-1.42647390514189e-02f, -7.37332916720468e-03f, -1.68282697438203e-03f,
+	-2.13374055278905e-04f, -1.45660718464996e-05f
+};
+
+static inline void
+rational_f32(const float *x, float *y, size_t x_len, float clamp,
+             float const *p, size_t np, float const *q, size_t nq)
+{
+	for (size_t vl; x_len > 0; x_len -= vl, x += vl, y += vl) {
+		vl = __riscv_vsetvl_e32m2(x_len);
+		vfloat32m2_t v = __riscv_vle32_v_f32m2(x, vl);
+		v = __riscv_vfmin_vf_f32m2(__riscv_vfmax_vf_f32m2(v, -clamp, vl), clamp, vl);
+		vfloat32m2_t z = __riscv_vfmul_vv_f32m2(v, v, vl);
+		vfloat32m2_t n = __riscv_vfmul_vv_f32m2(poly_f32(z, p, np, vl), v, vl);
+		__riscv_vse32_v_f32m2(y, __riscv_vfdiv_vv_f32m2(n, poly_f32(z, q, nq, vl), vl), vl);
+	}
+}
+
+void
+rvvlmf_tanh_relaxed(size_t x_len, const float *x, float *y)
+{
+	rational_f32(x, y, x_len, 7.90531110763549805f, tanh_f32_p, 7, tanh_f32_q, 4);
+}
+
+void
+rvvlmf_erf_relaxed(size_t x_len, const float *x, float *y)
+{
+	rational_f32(x, y, x_len, 4, erf_f32_p, 7, erf_f32_q, 5);
+}
@@ -1,5 +1,71 @@
 // code from https://github.com/simdutf/simdutf/tree/master/src/scalar
 
+int
+utf8_validate_scalar(const char *buf, size_t len)
+{
+	const uint8_t *data = (const uint8_t *)buf;
+	size_t pos = 0;
+	uint32_t code_point = 0;
+	while (pos < len) {
+		// check if the next 16 bytes are ascii.
+		size_t next_pos = pos + 16;
+		if (next_pos <= len) { // if it is safe to read 16 more bytes, check that they are ascii
+			uint64_t v1;
+			memcpy(&v1, data + pos, sizeof(uint64_t));
+			uint64_t v2;
+			memcpy(&v2, data + pos + sizeof(uint64_t), sizeof(uint64_t));
+			uint64_t v = v1 | v2;
+			if ((v & 0x8080808080808080) == 0) {
+				pos = next_pos;
+				continue;
+			}
+		}
+		uint8_t byte = data[pos];
+		while (byte < 0b10000000) {
+			if (++pos == len) { return 1; }
+			byte = data[pos];
+		}
+
+		if ((byte & 0b11100000) == 0b11000000) {
+			next_pos = pos + 2;
+			if (next_pos > len) { return 0; }
+			if ((data[pos + 1] & 0b11000000) != 0b10000000) { return 0; }
+			// range check
+			code_point = (byte & 0b00011111) << 6 | (data[pos + 1] & 0b00111111);
+			if ((code_point < 0x80) || (0x7ff < code_point)) { return 0; }
+		} else if ((byte & 0b11110000) == 0b11100000) {
+			next_pos = pos + 3;
+			if (next_pos > len) { return 0; }
+			if ((data[pos + 1] & 0b11000000) != 0b10000000) { return 0; }
+			if ((data[pos + 2] & 0b11000000) != 0b10000000) { return 0; }
+			// range check
+			code_point = (byte & 0b00001111) << 12 |
+				(data[pos + 1] & 0b00111111) << 6 |
+				(data[pos + 2] & 0b00111111);
+			if ((code_point < 0x800) || (0xffff < code_point) ||
+					(0xd7ff < code_point && code_point < 0xe000)) {
+				return 0;
+			}
+		} else if ((byte & 0b11111000) == 0b11110000) { // 0b11110000
+			next_pos = pos + 4;
+			if (next_pos > len) { return 0; }
+			if ((data[pos + 1] & 0b11000000) != 0b10000000) { return 0; }
+			if ((data[pos + 2] & 0b11000000) != 0b10000000) { return 0; }
+			if ((data[pos + 3] & 0b11000000) != 0b10000000) { return 0; }
+			// range check
+			code_point =
+				(byte & 0b00000111) << 18 | (data[pos + 1] & 0b00111111) << 12 |
+				(data[pos + 2] & 0b00111111) << 6 | (data[pos + 3] & 0b00111111);
+			if (code_point <= 0xffff || 0x10ffff < code_point) { return 0; }
+		} else {
+			// we may have a continuation
+			return 0;
+		}
+		pos = next_pos;
+	}
+	return 1;
+}
+
 // little endian
 size_t
 utf8_to_utf16_scalar(const char *buf, size_t len, uint16_t *utf16_output)
@@ -24,7 +24,7 @@ test(size_t length, size_t bitFlipCount)
 		in[randu64() % lenIn] ^= 1 << (randu64() & (sizeof *in - 1));
 
 	size_t lenGolden = utf16_to_utf8_scalar(in, lenIn, (char*)golden);
-	size_t lenOut = utf16_to_utf8_rvv(in, lenIn, (char*)out);
+	size_t lenOut = utf16_to_utf8_rvv(guard_place(in, lenIn * sizeof *in), lenIn, (char*)out);
 
 	if (lenGolden != lenOut) {
 		print("ERROR: length mismatch, expected ")(u,lenGolden)(" got ")(u,lenOut)(" from ")(u,origLen);
@@ -24,7 +24,7 @@ test(size_t length, size_t bitFlipCount)
 		in[randu64() % lenIn] ^= 1 << (randu64() & (sizeof *in - 1));
 
 	size_t lenGolden = utf8_to_utf16_scalar((char*)in, lenIn, golden);
-	size_t lenOut = utf8_to_utf16_rvv((char*)in, lenIn, out);
+	size_t lenOut = utf8_to_utf16_rvv(guard_place(in, lenIn), lenIn, out);
 
 	if (lenGolden != lenOut) {
 		print("ERROR: length mismatch, expected ")(u,lenGolden)(" got ")(u,lenOut)(" from ")(u,origLen)("\n");
@@ -23,7 +23,7 @@ test(size_t maxlen32, size_t bitFlipCount)
 
 	if (bitFlipCount)
 		len32 = utf8_to_utf32_scalar((char*)in, lenIn, utf32);
-	size_t lenOut = utf8_to_utf32_rvv((char*)in, lenIn, out);
+	size_t lenOut = utf8_to_utf32_rvv(guard_place(in, lenIn), lenIn, out);
 
 	if (len32 != lenOut) {
 		print("ERROR: length mismatch, expected ")(u,len32)(" got ")(u,lenOut)("\n");
@@ -30,3 +30,58 @@ print_b32(uint32_t val)
 	while (n--) *printIt++ = (val >> 31) + '0', val <<= 1;
 }
 
+#ifdef GUARD
+/* Build with -DGUARD to copy the input flush against a PROT_NONE page,
+ * alternating between ending right before and starting right after one,
+ * to catch impls reading past the input. The start cycles through the even
+ * offsets of 0 to 62 bytes from the page, which keeps UTF-16 input aligned.
+ * Requires a hosted environment. */
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define GUARD_MEM (1024*1024)
+
+static size_t guardLen;
+
+static void
+guard_handler(int sig)
+{
+	print("\nERROR: read past the input of length ")(u,guardLen)("\n");
+	print_flush();
+	_exit(EXIT_FAILURE);
+}
+
+static void *
+guard_place(void const *src, size_t n)
+{
+	static unsigned char *beg, *end;
+	static size_t toggle;
+	if (!beg) {
+		size_t page = sysconf(_SC_PAGESIZE);
+		unsigned char *map = mmap(0, GUARD_MEM + 2*page,
+		                          PROT_READ | PROT_WRITE,
+		                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (map == MAP_FAILED ||
+		    mprotect(map, page, PROT_NONE) ||
+		    mprotect(map + page + GUARD_MEM, page, PROT_NONE)) {
+			print("ERROR: failed to map guard pages\n");
+			print_flush();
+			exit(EXIT_FAILURE);
+		}
+		beg = map + page;
+		end = beg + GUARD_MEM;
+		signal(SIGSEGV, guard_handler);
+		signal(SIGBUS, guard_handler);
+	}
+	size_t off = toggle / 2 % 32 * 2;
+	if (off > GUARD_MEM - n)
+		off = 0;
+	unsigned char *dst = toggle++ & 1 ? beg + off : end - n;
+	guardLen = n;
+	memcpy(dst, src, n);
+	return dst;
+}
+#else
+#define guard_place(src, n) ((void*)(src))
+#endif